@@ -31,6 +31,12 @@ cd tools
     cd imgwrt
         make
     cd ..
+    cd nosexe
+        make
+    cd ..
+    cd nospack
+        make
+    cd ..
 cd ..
 
 echo **** Boot ****
@@ -58,6 +64,12 @@ cd system
     cd shell
         make
     cd ..
+    cd twin
+        make
+    cd ..
+    cd hog
+        make
+    cd ..
 cd ..
 
 echo **** DONE ****
\ No newline at end of file
@@ -29,5 +29,6 @@
     #define CALL_VIDEO_BIOS() asm int 0x10
     #define CALL_MEMORY_BIOS() asm int 0x12
     #define CALL_DISKETTE_BIOS() asm int 0x13
+    #define CALL_SYSTEM_BIOS() asm int 0x15
     #define CALL_KEYBOARD_BIOS() asm int 0x16
 #endif
\ No newline at end of file
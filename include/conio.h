@@ -25,16 +25,37 @@
 
 #ifndef __CONIO_H
     #define __CONIO_H
+    #include <stdarg.h> /* va_list */
 
     #define BLINK_COLOR 128
     #define MAKE_COLOR(BACKGROUND, FORGROUND) (BACKGROUND << 4 | FORGROUND)
     #define CONSOLE_LINE_FEED 10
     #define CONSOLE_CARRIAGE_RETURN 13
     #define CONSOLE_BACKSPACE 8
+    #define CONSOLE_BELL 7
     
     #define SCREEN_WIDTH 80
     #define SCREEN_HEIGHT 25
 
+    /* color text mode, the console writes the character and attribute
+       cells and moves the hardware cursor on flushConsole */
+    #define VIDEO_SEGMENT 0xb800
+    #define VIDEO_PAGE_SIZE 0x1000 /* bytes */
+    #define CRTC_INDEX_PORT 0x3d4
+    #define CRTC_DATA_PORT 0x3d5
+    #define CRTC_CURSOR_HIGH 0x0e
+    #define CRTC_CURSOR_LOW 0x0f
+    #define BIOS_DATA_SEGMENT 0x40
+    #define BIOS_CURSOR_POSITION 0x50 /* column and row bytes per page */
+    #define LOGGER_PORT 0xe9 /* Bochs port E9h hack */
+    #define LOGGER_BUFFER_SIZE 2048 /* power of two */
+    #define LOGGER_DRAIN_PER_TICK 64
+    #define LOGGER_DRAIN_IDLE 256
+
+    #define FORMAT_BUFFER_SIZE 128 /* printFormat stack buffer */
+    #define FORMAT_DIGITS 11 /* 32 bit octal */
+    #define FORMAT_NO_STREAM -1
+
     enum PRINT_STREAM {
         STDOUT = 0, /* print on console */
         LOGGER = 1 /* print on Bochs console log */
@@ -67,6 +88,8 @@
         COLUMN
     };
 
+    void initializeConsole(void);
+    void flushConsole(void);
     void setTextcolor(unsigned char newcolor);
     void setActivePage(unsigned char page);
     void setCursorPosition(unsigned char row, unsigned char column);
@@ -77,11 +100,21 @@
     unsigned int convertHexStringToInteger(unsigned char *hexNumber);
     void printCharacter(enum PRINT_STREAM stream, unsigned char character);
     void printString(enum PRINT_STREAM stream, char *string);
+    void writeStream(enum PRINT_STREAM stream, char far *buffer, unsigned int bufferLength);
     void printFormat(enum PRINT_STREAM stream, char* format, ...);
+    unsigned int formatOutput(int stream, char far *buffer, unsigned int bufferSize,
+                              char *format, va_list arguments);
+    int formatString(char far *buffer, unsigned int bufferSize, char *format, va_list arguments);
+    int printToString(char far *buffer, unsigned int bufferSize, char *format, ...);
     unsigned char readCharacter(void);
+    unsigned char isKeyAvailable(void);
     unsigned char *readString(unsigned char *string);
     unsigned char inPortByte(unsigned int portNumber);
     unsigned int inPortWord(unsigned int portNumber);
+    void enableLoggerBuffer(void);
+    unsigned int drainLogger(unsigned int maximumBytes);
+    void flushLogger(void);
+    void dumpLoggerStatistics(enum PRINT_STREAM stream);
     void outPortByte(unsigned int portNumber, unsigned char value);
     void outPortWord(unsigned int portNumber, unsigned int value);
 #endif
\ No newline at end of file
@@ -0,0 +1,49 @@
+/************************************************************************
+* Copyright (C) 2020 by Ahmad Dajani                                    *
+*                                                                       *
+* This file is part of NOS.                                             *
+*                                                                       *
+* NOS is free software: you can redistribute it and/or modify it        *
+* under the terms of the GNU Lesser General Public License as published *
+* by the Free Software Foundation, either version 3 of the License, or  *
+* (at your option) any later version.                                   *
+*                                                                       *
+* NOS is distributed in the hope that it will be useful,                *
+* but WITHOUT ANY WARRANTY* without even the implied warranty of        *
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+* GNU Lesser General Public License for more details.                   *
+*                                                                       *
+* You should have received a copy of the GNU Lesser General Public      *
+* License along with NOS.  If not, see <http://www.gnu.org/licenses/>.  *
+************************************************************************/
+
+/*@file arena.h
+* @author Ahmad Dajani <eng.adajani@gmail.com>
+* @date 19 Oct 2026
+* @brief Kernel arena allocator header file
+*/
+
+#ifndef __ARENA_H
+    #define __ARENA_H
+
+    /* default region size, bigger requests get a region of their own */
+    #define ARENA_REGION_SIZE 2048UL
+
+    struct ArenaRegion {
+        struct ArenaRegion far *next;
+        unsigned long size; /* usable bytes after the header */
+        unsigned long used;
+    };
+
+    struct Arena {
+        struct ArenaRegion far *regions;
+        unsigned long bytesAllocated;
+        unsigned int regionsCount;
+    };
+
+    void initializeArena(struct Arena far *arena);
+    void far *arenaAllocate(struct Arena far *arena, unsigned long size);
+    void far *arenaAllocateAligned(struct Arena far *arena, unsigned long size);
+    int arenaFree(struct Arena far *arena, void far *address);
+    void releaseArena(struct Arena far *arena);
+#endif
\ No newline at end of file
@@ -0,0 +1,46 @@
+/************************************************************************
+* Copyright (C) 2020 by Ahmad Dajani                                    *
+*                                                                       *
+* This file is part of NOS.                                             *
+*                                                                       *
+* NOS is free software: you can redistribute it and/or modify it        *
+* under the terms of the GNU Lesser General Public License as published *
+* by the Free Software Foundation, either version 3 of the License, or  *
+* (at your option) any later version.                                   *
+*                                                                       *
+* NOS is distributed in the hope that it will be useful,                *
+* but WITHOUT ANY WARRANTY* without even the implied warranty of        *
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+* GNU Lesser General Public License for more details.                   *
+*                                                                       *
+* You should have received a copy of the GNU Lesser General Public      *
+* License along with NOS.  If not, see <http://www.gnu.org/licenses/>.  *
+************************************************************************/
+
+/*@file context.h
+* @author Ahmad Dajani <eng.adajani@gmail.com>
+* @date 19 Oct 2026
+* @brief Kernel execution context header file
+* @see context.asm
+*/
+
+#ifndef __CONTEXT_H
+    #define __CONTEXT_H
+
+    /* @note offsets are used by context.asm */
+    struct Context {
+        unsigned int stackPointer;
+        unsigned int basePointer;
+        unsigned int sourceIndex;
+        unsigned int destinationIndex;
+        unsigned int instructionPointer;
+        unsigned int stackSegment;
+        unsigned int dataSegment;
+        unsigned int extraSegment;
+        unsigned int flags;
+    };
+
+    int saveContext(struct Context far *context);
+    void restoreContext(struct Context far *context, int value);
+    int callOnKernelStack(int (*function)(void), void *stackTop);
+#endif
\ No newline at end of file
@@ -27,6 +27,12 @@
     #define __KERNEL_DEBUG_H
     #include <conio.h> /* outPortWord */
 
+    /* #define DEBUG_BREAKPOINTS */
+
     /* Stops simulation and breaks into the debug console */
-    #define DebugBreak() outPortWord(0x8A00, 0x8A00); outPortWord(0x8A00, 0x08AE0);
+    #ifdef DEBUG_BREAKPOINTS
+        #define DebugBreak() do { outPortWord(0x8A00, 0x8A00); outPortWord(0x8A00, 0x08AE0); } while(0)
+    #else
+        #define DebugBreak() do { } while(0)
+    #endif
 #endif
\ No newline at end of file
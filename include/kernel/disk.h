@@ -27,12 +27,6 @@
     #define __DISK_H
     #define DISK_ATTEMPT 3
 
-    /* #define DISK_DEBUG */
-
-    #ifdef DISK_DEBUG
-        #include <conio.h> /* printFormat */
-    #endif
-
     #define SECTOR_SIZE 512
 
     enum OPERATION_STATUS {
@@ -64,4 +58,5 @@
                       unsigned char head, unsigned char drive, void far *buffer);
     int DiskOperationLBA(unsigned char operation, unsigned char numberOfSectors, unsigned int logicalBlockAddressing,
                          unsigned char drive, void far *buffer);
+    unsigned int getSectorsToTrackEnd(unsigned int logicalBlockAddressing);
 #endif
\ No newline at end of file
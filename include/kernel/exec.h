@@ -25,7 +25,9 @@
 
 #ifndef __EXEC_H
     #define __EXEC_H
-    #define EXEC_DEBUG
+    #include <kernel/sched.h> /* Task, Event */
+    #include <kernel/service.h> /* FILE_PATH_SIZE */
+    #include <conio.h> /* PRINT_STREAM */
 
     #define EXE_SIGNATURE 0x5a4d
 
@@ -40,6 +42,49 @@
         asm { DB 0xCB               }\
         } while(0);
 
+    /* same as FAR_JUMP, DS and ES are set last since _cs_ and _ip_ are
+       addressed through DS */
+    #define FAR_JUMP_WITH_DATA(_ss_, _sp_, _cs_, _ip_, _ds_) do { \
+        asm { mov ss, word ptr _ss_ }\
+        asm { mov sp, word ptr _sp_ }\
+        asm { push    word ptr _cs_ }\
+        asm { push    word ptr _ip_ }\
+        asm { mov ax, word ptr _ds_ }\
+        asm { mov es, ax            }\
+        asm { mov ds, ax            }\
+        asm { DB 0xCB               }\
+        } while(0);
+
+    /* #define EXEC_SELF_TEST */
+    #define PROGRAM_TASKS 3 /* programs running at once besides the shell */
+    #define PROGRAM_STACK_SIZE 2048 /* executeBinary and the file system */
+
+    #define COM_LOAD_OFFSET 0x100
+    #define COM_STACK_POINTER 0xfffe
+    #define COM_MAX_SIZE (0x10000UL - COM_LOAD_OFFSET - 2)
+
+    enum IMAGE_TYPE {
+        IMAGE_MZ,
+        IMAGE_NXE,
+        IMAGE_SHARED_NXE, /* code shared between instances, @see shared.h */
+        IMAGE_COM
+    };
+
+    #define PROGRAM_SEGMENT_PREFIX_PARAGRAPHS 0x10
+    #define ENVIRONMENT_PARAGRAPH 5 /* the environment is kept in the unused FCB area */
+
+    /* @see DOS program segment prefix, only the used fields */
+    struct ProgramSegmentPrefix {
+        unsigned char exitCall[2]; /* INT 20h */
+        unsigned int memoryTop; /* segment after the program memory */
+        unsigned char reserved[0x28];
+        unsigned int environmentSegment;
+        unsigned char reserved2[0x22];
+        unsigned char environment[0x30]; /* no variables, then the program name count */
+        unsigned char commandLength;
+        unsigned char commandLine[127];
+    };
+
     struct ExecutableFile {
         unsigned int signature; /* MZ */
         unsigned int imageLength; /* mod 512 */
@@ -62,5 +107,27 @@
         unsigned int segment;
     };
 
+    enum PROGRAM_STATE {
+        PROGRAM_FREE = 0,
+        PROGRAM_RUNNING,
+        PROGRAM_FINISHED
+    };
+
+    /* a task that runs the spawned programs one after the other */
+    struct ProgramTask {
+        struct Task *task;
+        struct Event start;
+        struct Event finished;
+        enum PROGRAM_STATE state;
+        char path[FILE_PATH_SIZE];
+        int exitCode; /* or the executeBinary error */
+    };
+
     int executeBinary(char *path);
+    void initializePrograms(void);
+    int spawnProgram(char *path);
+    int waitProgram(unsigned int program);
+    #ifdef EXEC_SELF_TEST
+    void testPrograms(enum PRINT_STREAM stream);
+    #endif
 #endif
\ No newline at end of file
@@ -0,0 +1,70 @@
+/************************************************************************
+* Copyright (C) 2020 by Ahmad Dajani                                    *
+*                                                                       *
+* This file is part of NOS.                                             *
+*                                                                       *
+* NOS is free software: you can redistribute it and/or modify it        *
+* under the terms of the GNU Lesser General Public License as published *
+* by the Free Software Foundation, either version 3 of the License, or  *
+* (at your option) any later version.                                   *
+*                                                                       *
+* NOS is distributed in the hope that it will be useful,                *
+* but WITHOUT ANY WARRANTY* without even the implied warranty of        *
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+* GNU Lesser General Public License for more details.                   *
+*                                                                       *
+* You should have received a copy of the GNU Lesser General Public      *
+* License along with NOS.  If not, see <http://www.gnu.org/licenses/>.  *
+************************************************************************/
+
+/*@file extmem.h
+* @author Ahmad Dajani <eng.adajani@gmail.com>
+* @date 19 Oct 2026
+* @brief Extended memory (above 1MB) manager header file
+* @note The memory is not addressable in real mode, blocks are accessed
+*       by copying through INT 15h AH=87h block moves.
+*/
+
+#ifndef __EXTMEM_H
+    #define __EXTMEM_H
+    #include <conio.h> /* PRINT_STREAM */
+
+    /* the first 64KB above 1MB is the HMA, it is left for the kernel */
+    #define EXTENDED_MEMORY_START 0x110000UL
+    #define EXTENDED_MEMORY_BLOCKS 32
+    /* INT 15h AH=87h moves at most 0x8000 words per call */
+    #define EXTENDED_MEMORY_MAX_MOVE 0x10000UL
+
+    struct ExtendedMemoryBlock {
+        unsigned long address; /* linear address */
+        unsigned long size;
+        unsigned int isAvailable;
+    };
+
+    /* @see INT 15h AH=87h global descriptor table */
+    struct SegmentDescriptor {
+        unsigned int limit;
+        unsigned int baseLow;
+        unsigned char baseMiddle;
+        unsigned char access;
+        unsigned char reserved[2];
+    };
+
+    struct BlockMoveTable {
+        struct SegmentDescriptor dummy;
+        struct SegmentDescriptor globalDescriptorTable;
+        struct SegmentDescriptor source;
+        struct SegmentDescriptor destination;
+        struct SegmentDescriptor biosCode;
+        struct SegmentDescriptor biosStack;
+    };
+
+    void initializeExtendedMemory(void);
+    unsigned long getExtendedMemorySize(void);
+    unsigned long extendedMemoryAllocate(unsigned long size);
+    void extendedMemoryFree(unsigned long address);
+    int copyExtendedMemory(unsigned long destination, unsigned long source, unsigned long size);
+    int copyToExtendedMemory(unsigned long destination, void far *source, unsigned long size);
+    int copyFromExtendedMemory(void far *destination, unsigned long source, unsigned long size);
+    void dumpExtendedMemory(enum PRINT_STREAM stream);
+#endif
\ No newline at end of file
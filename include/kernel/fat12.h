@@ -33,8 +33,6 @@ a FAT12 file system contains 1.5 bytes per cluster within the file allocation ta
     /* @link: https://www.eit.lth.se/fileadmin/eit/courses/eitn50/Literature/fat12_description.pdf */
     #include <conio.h> / * PRINT_STREAM */
 
-    #define FAT12_DEBUG
-
     #define FAT12_BADSECTOR    0x0ff7
     #define FAT12_INVALIDENTRY 0x0001
     #define FAT12_RESERVEDs    0x0ff0
@@ -28,8 +28,6 @@
     #include <kernel/disk.h> /* initializeDisk */
     #include <kernel/fat12.h> /* initializeFAT12, getFatTable */
 
-    /* #define FILESYS_DEBUG */
-
     struct ClusterChain {
         unsigned int cluster;
         unsigned int size;
@@ -48,6 +46,19 @@
         struct FileTime lastWriteTime;
         struct FileDate lastWriteDate;
         struct ClusterChain far *clusterChain;
+        struct File far *next; /* open files list */
+        unsigned long position; /* API_FILE_READ/API_FILE_SEEK */
+        struct ClusterChain far *cursorChunk; /* chain node of cursorSector, NULL for none */
+        unsigned long cursorSector; /* first sector of the last readFile */
+    };
+
+    /* API_FILE_STAT result */
+    struct FileStatus {
+        unsigned char name[FILE_NAME_SIZE];
+        unsigned char extension[FILE_EXTENSION_SIZE];
+        unsigned long size;
+        struct FileTime lastWriteTime;
+        struct FileDate lastWriteDate;
     };
 
     struct File far *fopen(char *path);
@@ -55,7 +66,9 @@
     struct FileInformation far *readDirectoryContent(unsigned int cluster, char *fileNameNext);
     struct ClusterChain far *buildFileClusterChain(struct FileInformation far *fileInformation);
     void fclose(struct File far *file);
+    void closeProcessFiles(unsigned int processId);
     void loadFile(struct File far *file, unsigned char far *outBuffer);
+    unsigned long readFile(struct File far *file, unsigned long offset, void far *outBuffer, unsigned long length);
     void printFileName(enum PRINT_STREAM stream, unsigned char far *name, unsigned int size);
     void showDirectory(unsigned char far *rootTable);
     void initializeFileSystem(unsigned char bootDrive);
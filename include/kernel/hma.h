@@ -0,0 +1,48 @@
+/************************************************************************
+* Copyright (C) 2020 by Ahmad Dajani                                    *
+*                                                                       *
+* This file is part of NOS.                                             *
+*                                                                       *
+* NOS is free software: you can redistribute it and/or modify it        *
+* under the terms of the GNU Lesser General Public License as published *
+* by the Free Software Foundation, either version 3 of the License, or  *
+* (at your option) any later version.                                   *
+*                                                                       *
+* NOS is distributed in the hope that it will be useful,                *
+* but WITHOUT ANY WARRANTY* without even the implied warranty of        *
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+* GNU Lesser General Public License for more details.                   *
+*                                                                       *
+* You should have received a copy of the GNU Lesser General Public      *
+* License along with NOS.  If not, see <http://www.gnu.org/licenses/>.  *
+************************************************************************/
+
+/*@file hma.h
+* @author Ahmad Dajani <eng.adajani@gmail.com>
+* @date 19 Oct 2026
+* @brief High memory area (FFFF:0010) header file
+*/
+
+#ifndef __HMA_H
+    #define __HMA_H
+
+    #define HMA_SEGMENT 0xffff
+    #define HMA_START_OFFSET 0x10UL
+    #define HMA_END_OFFSET 0x10000UL
+    /* smallest tail that is split into a new free block */
+    #define HMA_MINIMUM_SPLIT (sizeof(struct HighMemoryBlock) + 16)
+
+    struct HighMemoryBlock {
+        unsigned int size; /* include the header */
+        unsigned int isAvailable;
+    };
+
+    void initializeHighMemory(void);
+    int enableA20(void);
+    int isA20Enabled(void);
+    int isHighMemoryAvailable(void);
+    void far *hmalloc(unsigned int size);
+    void hfree(void far *address);
+    void far *kmallocHigh(unsigned long size);
+    void kfreeHigh(void far *address);
+#endif
\ No newline at end of file
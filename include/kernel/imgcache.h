@@ -0,0 +1,73 @@
+/************************************************************************
+* Copyright (C) 2020 by Ahmad Dajani                                    *
+*                                                                       *
+* This file is part of NOS.                                             *
+*                                                                       *
+* NOS is free software: you can redistribute it and/or modify it        *
+* under the terms of the GNU Lesser General Public License as published *
+* by the Free Software Foundation, either version 3 of the License, or  *
+* (at your option) any later version.                                   *
+*                                                                       *
+* NOS is distributed in the hope that it will be useful,                *
+* but WITHOUT ANY WARRANTY* without even the implied warranty of        *
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+* GNU Lesser General Public License for more details.                   *
+*                                                                       *
+* You should have received a copy of the GNU Lesser General Public      *
+* License along with NOS.  If not, see <http://www.gnu.org/licenses/>.  *
+************************************************************************/
+
+/*@file imgcache.h
+* @author Ahmad Dajani <eng.adajani@gmail.com>
+* @date 19 Oct 2026
+* @brief Loaded executable image cache header file
+*/
+
+#ifndef __IMGCACHE_H
+    #define __IMGCACHE_H
+    #include <kernel/fat12.h> /* FileInformation */
+    #include <kernel/exec.h> /* ExecutableFile, RelocationTable */
+    #include <conio.h> /* PRINT_STREAM */
+
+    #define IMAGE_CACHE_ENTRIES 8
+    #define IMAGE_CACHE_PATH_SIZE 40
+    /* default budgets, @see setImageCacheBudget */
+    #define IMAGE_CACHE_EXTENDED_BUDGET 0x40000UL
+    #define IMAGE_CACHE_CONVENTIONAL_BUDGET 0x8000UL
+
+    /* an image is valid as long as its directory entry didn't change */
+    struct ImageCacheKey {
+        char path[IMAGE_CACHE_PATH_SIZE];
+        unsigned long size;
+        unsigned int lastWriteTime;
+        unsigned int lastWriteDate;
+        unsigned int firstLogicalCluster;
+    };
+
+    /* storage layout: pristine load module followed by the relocation table */
+    struct CachedImage {
+        struct ImageCacheKey key;
+        struct ExecutableFile header;
+        unsigned long address; /* linear address of the storage */
+        unsigned long storageSize;
+        unsigned long loadModuleSize;
+        unsigned int lastUsed;
+        unsigned int isExtended;
+        unsigned int isUsed;
+    };
+
+    void initializeImageCache(void);
+    void setImageCacheBudget(unsigned long budget);
+    int makeImageCacheKey(struct ImageCacheKey *key, char *path, struct FileInformation far *fileInformation);
+    int isImageCacheKeyEqual(struct ImageCacheKey *left, struct ImageCacheKey *right);
+    struct CachedImage *findCachedImage(struct ImageCacheKey *key);
+    struct CachedImage *cacheImage(struct ImageCacheKey *key, struct ExecutableFile *header,
+                                   void far *image, unsigned long loadModuleSize);
+    void dropCachedImage(struct CachedImage *cachedImage);
+    int loadCachedImage(struct CachedImage *cachedImage, void far *image);
+    int readCachedRelocations(struct CachedImage *cachedImage, unsigned int firstItem,
+                              struct RelocationTable far *relocations, unsigned int count);
+    int writeCachedRelocations(struct CachedImage *cachedImage, unsigned int firstItem,
+                               struct RelocationTable far *relocations, unsigned int count);
+    void dumpImageCache(enum PRINT_STREAM stream);
+#endif
\ No newline at end of file
@@ -0,0 +1,83 @@
+/************************************************************************
+* Copyright (C) 2020 by Ahmad Dajani                                    *
+*                                                                       *
+* This file is part of NOS.                                             *
+*                                                                       *
+* NOS is free software: you can redistribute it and/or modify it        *
+* under the terms of the GNU Lesser General Public License as published *
+* by the Free Software Foundation, either version 3 of the License, or  *
+* (at your option) any later version.                                   *
+*                                                                       *
+* NOS is distributed in the hope that it will be useful,                *
+* but WITHOUT ANY WARRANTY* without even the implied warranty of        *
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+* GNU Lesser General Public License for more details.                   *
+*                                                                       *
+* You should have received a copy of the GNU Lesser General Public      *
+* License along with NOS.  If not, see <http://www.gnu.org/licenses/>.  *
+************************************************************************/
+
+/*@file log.h
+* @author Ahmad Dajani <eng.adajani@gmail.com>
+* @date 19 Oct 2026
+* @brief Kernel logging header file
+* @note Turbo C has no variadic macros, the printFormat arguments of a log
+*       call are passed in their own parentheses:
+*           logTrace(LOG_FAT, ("found at lba=%d\n", cluster));
+*/
+
+#ifndef __LOG_H
+    #define __LOG_H
+
+    /* levels, a call site above LOG_LEVEL is compiled out with its arguments */
+    #define LOG_ERROR 0
+    #define LOG_WARNING 1
+    #define LOG_INFO 2
+    #define LOG_TRACE 3
+    #define LOG_LEVELS 4
+
+    #ifndef LOG_LEVEL
+        #define LOG_LEVEL LOG_WARNING /* LOG_TRACE for debugging */
+    #endif
+
+    /* subsystems, a bit each in the runtime mask of a level */
+    #define LOG_DISK 0x01 /* disk */
+    #define LOG_FAT 0x02 /* fat12 */
+    #define LOG_FS 0x04 /* filesys */
+    #define LOG_MEM 0x08 /* memory, hma, extmem, arena, pheap */
+    #define LOG_EXEC 0x10 /* exec, imgcache, shared: loading images */
+    #define LOG_SVC 0x20 /* service */
+    #define LOG_SCHED 0x40 /* sched, timer, process, swap: running and residency */
+    #define LOG_ALL 0x7f
+
+    extern unsigned char logMask[LOG_LEVELS];
+
+    /* one memory test, the message is formatted only when it passes */
+    #define isLogEnabled(level, subsystem) (logMask[level] & (subsystem))
+    #define LOG_CALL(level, subsystem, arguments) \
+        ((void)(isLogEnabled(level, subsystem) && (logPrint arguments, 1)))
+
+    #define logError(subsystem, arguments) LOG_CALL(LOG_ERROR, subsystem, arguments)
+
+    #if LOG_LEVEL >= LOG_WARNING
+        #define logWarning(subsystem, arguments) LOG_CALL(LOG_WARNING, subsystem, arguments)
+    #else
+        #define logWarning(subsystem, arguments) ((void)0)
+    #endif
+
+    #if LOG_LEVEL >= LOG_INFO
+        #define logInfo(subsystem, arguments) LOG_CALL(LOG_INFO, subsystem, arguments)
+    #else
+        #define logInfo(subsystem, arguments) ((void)0)
+    #endif
+
+    #if LOG_LEVEL >= LOG_TRACE
+        #define logTrace(subsystem, arguments) LOG_CALL(LOG_TRACE, subsystem, arguments)
+    #else
+        #define logTrace(subsystem, arguments) ((void)0)
+    #endif
+
+    void logPrint(char *format, ...);
+    /* API_LOG_MASK, @return the previous mask of the level */
+    unsigned char setLogMask(unsigned int level, unsigned char subsystems);
+#endif
\ No newline at end of file
@@ -25,14 +25,18 @@
 
 #ifndef __KMEM_H
     #define __KMEM_H
+    #include <conio.h> /* PRINT_STREAM */
 
-    #define KMEM_DEBUG
+    /* log every kmalloc/kfree for tools/kmembench */
+    /* #define KMEM_TRACE */
 
     #ifndef NULL
         #define NULL 0
     #endif
 
     #define KMALLOC_PRIME_MAGIC 59473U
+    /* smallest tail that is split into a new free block */
+    #define KMALLOC_MINIMUM_SPLIT (sizeof(struct MemoryControlBlock) + 16)
 
     struct MemoryControlBlock {
         unsigned int isInitialized : 1;
@@ -41,10 +45,30 @@
         unsigned long size;
     };
 
+    /* @note: sizes are in bytes and include the MCB header */
+    struct HeapStatistics {
+        unsigned long heapSize;
+        unsigned long bytesInUse;
+        unsigned long highWaterMark;
+        unsigned long freeBytes; /* inside free MCBs */
+        unsigned long largestFreeBlock;
+        unsigned long untouchedBytes; /* lastValidAddress - initializedAddress */
+        unsigned long allocations;
+        unsigned long frees;
+        unsigned int blocks;
+        unsigned int freeBlocks;
+        unsigned int isCorrupted;
+    };
+
     unsigned long getLastValidAddress(void);
     void far *convertLinearAddressToFarPointer(unsigned long address);
+    unsigned long convertFarPointerToLinearAddress(void far *address);
     void initializeMemory(unsigned int heapStart);
     void far *kmalloc(unsigned long size);
     void far *kmalloc_align(unsigned long size);
+    void far *kmalloc_at(void far *address, unsigned long size);
+    unsigned long getAllocationSize(void far *address);
     void kfree(void far *address);
+    void getHeapStatistics(struct HeapStatistics far *statistics);
+    void dumpHeapStatistics(enum PRINT_STREAM stream);
 #endif
\ No newline at end of file
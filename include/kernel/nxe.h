@@ -0,0 +1,88 @@
+/************************************************************************
+* Copyright (C) 2020 by Ahmad Dajani                                    *
+*                                                                       *
+* This file is part of NOS.                                             *
+*                                                                       *
+* NOS is free software: you can redistribute it and/or modify it        *
+* under the terms of the GNU Lesser General Public License as published *
+* by the Free Software Foundation, either version 3 of the License, or  *
+* (at your option) any later version.                                   *
+*                                                                       *
+* NOS is distributed in the hope that it will be useful,                *
+* but WITHOUT ANY WARRANTY* without even the implied warranty of        *
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+* GNU Lesser General Public License for more details.                   *
+*                                                                       *
+* You should have received a copy of the GNU Lesser General Public      *
+* License along with NOS.  If not, see <http://www.gnu.org/licenses/>.  *
+************************************************************************/
+
+/*@file nxe.h
+* @author Ahmad Dajani <eng.adajani@gmail.com>
+* @date 19 Oct 2026
+* @brief NOS native executable (NXE) format header
+* @note Shared with tools\nosexe, keep it free from kernel includes.
+*
+* File layout:
+*   sector 0..headerSectors-1  NativeExecutableFile followed by the fixups
+*   sector headerSectors..     load module (sector aligned)
+*
+* Fixups are sorted and grouped in windows, a window covers less than 64KB:
+*   word  segment (paragraphs from the image base)
+*   word  fixups count
+*   delta from the previous offset in the window (the first from 0):
+*         byte 1..255, or byte 0 followed by a word
+* Each fixup adds (imageBase - linkedBase) to the word at segment:offset.
+*
+* Packed load modules (NXE_COMPRESSED, tools\nospack) are LZSS streams:
+*   flag byte, bit 0 first: 1 literal byte follows,
+*                           0 match follows as two bytes:
+*                             distance low 8 bits,
+*                             distance high 4 bits << 4 | length - 3
+*   distance 1..4095 bytes back in the output, length 3..18
+*
+* Shared code images (NXE_SHARED_CODE, nosexe -share) start with
+* codeParagraphs of read-only code, loaded once for all the instances,
+* the rest of the load module and minParagraphs are private to each one.
+* Fixups in the code only refer to the code, the entry gets DS=ES of the
+* private data (paragraph codeParagraphs of the image).
+*/
+
+#ifndef __NXE_H
+    #define __NXE_H
+
+    #define NXE_SIGNATURE 0x584e /* NX */
+    #define NXE_VERSION 2
+    #define NXE_HEADER_ALIGN 512 /* @see SECTOR_SIZE */
+    #define NXE_WINDOW_SIZE 0xfff0UL
+
+    /* nxe flags */
+    #define NXE_FIXED_BASE 1 /* fixups stripped, loads at linkedBase only */
+    #define NXE_COMPRESSED 2 /* load module is packed, packedSize bytes */
+    #define NXE_SHARED_CODE 4 /* code is shared between instances, never packed */
+
+    #define NXE_PACK_WINDOW 0x1000U
+    #define NXE_PACK_MIN_MATCH 3
+    #define NXE_PACK_MAX_MATCH 18
+    /* the unpacker moves its segment forward at this offset */
+    #define NXE_PACK_NORMALIZE_AT 0xe000U
+
+    struct NativeExecutableFile {
+        unsigned int signature; /* NX */
+        unsigned int version;
+        unsigned int flags;
+        unsigned int headerSectors; /* header and fixups, in sectors */
+        unsigned long loadModuleSize; /* in bytes */
+        unsigned int minParagraphs; /* needed after the load module */
+        unsigned int linkedBase; /* segment the fixups were applied for, 0 for none */
+        unsigned int stackSegment; /* relative to the image base */
+        unsigned int stackPointer;
+        unsigned int codeSegment; /* relative to the image base */
+        unsigned int instructionPointer;
+        unsigned int fixupWindows;
+        unsigned int fixupsCount;
+        unsigned int fixupBytes; /* encoded size, after the header */
+        unsigned long packedSize; /* stored load module size if NXE_COMPRESSED */
+        unsigned int codeParagraphs; /* shared code size if NXE_SHARED_CODE */
+    };
+#endif
\ No newline at end of file
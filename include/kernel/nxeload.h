@@ -0,0 +1,37 @@
+/************************************************************************
+* Copyright (C) 2020 by Ahmad Dajani                                    *
+*                                                                       *
+* This file is part of NOS.                                             *
+*                                                                       *
+* NOS is free software: you can redistribute it and/or modify it        *
+* under the terms of the GNU Lesser General Public License as published *
+* by the Free Software Foundation, either version 3 of the License, or  *
+* (at your option) any later version.                                   *
+*                                                                       *
+* NOS is distributed in the hope that it will be useful,                *
+* but WITHOUT ANY WARRANTY* without even the implied warranty of        *
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+* GNU Lesser General Public License for more details.                   *
+*                                                                       *
+* You should have received a copy of the GNU Lesser General Public      *
+* License along with NOS.  If not, see <http://www.gnu.org/licenses/>.  *
+************************************************************************/
+
+/*@file nxeload.h
+* @author Ahmad Dajani <eng.adajani@gmail.com>
+* @date 19 Oct 2026
+* @brief NXE fixups and packed load modules header file
+* @see include\kernel\nxe.h
+*/
+
+#ifndef __NXELOAD_H
+    #define __NXELOAD_H
+    #include <kernel/nxe.h> /* NativeExecutableFile */
+    #include <kernel/filesys.h> /* File, readFile */
+
+    /* @return 0 when the file can't be read or the stream is not valid */
+    int unpackImage(struct File far *file, unsigned long offset, unsigned long packedSize,
+                    unsigned char far *image, unsigned long loadModuleSize);
+    int relocateNativeImage(struct File far *file, struct NativeExecutableFile *nativeHeader,
+                            unsigned int codeBase, unsigned int dataBase, int isCodeRelocated);
+#endif
\ No newline at end of file
@@ -0,0 +1,56 @@
+/************************************************************************
+* Copyright (C) 2020 by Ahmad Dajani                                    *
+*                                                                       *
+* This file is part of NOS.                                             *
+*                                                                       *
+* NOS is free software: you can redistribute it and/or modify it        *
+* under the terms of the GNU Lesser General Public License as published *
+* by the Free Software Foundation, either version 3 of the License, or  *
+* (at your option) any later version.                                   *
+*                                                                       *
+* NOS is distributed in the hope that it will be useful,                *
+* but WITHOUT ANY WARRANTY* without even the implied warranty of        *
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+* GNU Lesser General Public License for more details.                   *
+*                                                                       *
+* You should have received a copy of the GNU Lesser General Public      *
+* License along with NOS.  If not, see <http://www.gnu.org/licenses/>.  *
+************************************************************************/
+
+/*@file pheap.h
+* @author Ahmad Dajani <eng.adajani@gmail.com>
+* @date 19 Oct 2026
+* @brief Process paragraph heap header file
+* @note Blocks are segment:0 with a one paragraph header in front, as DOS
+*       memory blocks. Chunks come from the process arena.
+*/
+
+#ifndef __PHEAP_H
+    #define __PHEAP_H
+    #include <kernel/arena.h> /* Arena */
+
+    #define PARAGRAPH_HEAP_CHUNKS 8
+    #define PARAGRAPH_HEAP_GROWTH 0x100 /* paragraphs (4KB) per new chunk at least */
+    #define PARAGRAPH_BLOCK_SIGNATURE 0x4d48 /* HM */
+
+    /* @note one paragraph, in front of every block */
+    struct ParagraphBlock {
+        unsigned int signature;
+        unsigned int paragraphs; /* after the header */
+        unsigned int isUsed;
+        unsigned char reserved[10];
+    };
+
+    struct ParagraphHeap {
+        unsigned int chunkSegment[PARAGRAPH_HEAP_CHUNKS]; /* first block header */
+        unsigned int chunkParagraphs[PARAGRAPH_HEAP_CHUNKS]; /* headers included */
+        unsigned int chunksCount;
+    };
+
+    void initializeParagraphHeap(struct ParagraphHeap far *heap);
+    unsigned int allocateParagraphs(struct ParagraphHeap far *heap, struct Arena far *arena,
+                                    unsigned int paragraphs, unsigned int *largest);
+    int freeParagraphs(struct ParagraphHeap far *heap, unsigned int segment);
+    int resizeParagraphs(struct ParagraphHeap far *heap, unsigned int segment,
+                         unsigned int paragraphs, unsigned int *largest);
+#endif
\ No newline at end of file
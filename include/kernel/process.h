@@ -0,0 +1,67 @@
+/************************************************************************
+* Copyright (C) 2020 by Ahmad Dajani                                    *
+*                                                                       *
+* This file is part of NOS.                                             *
+*                                                                       *
+* NOS is free software: you can redistribute it and/or modify it        *
+* under the terms of the GNU Lesser General Public License as published *
+* by the Free Software Foundation, either version 3 of the License, or  *
+* (at your option) any later version.                                   *
+*                                                                       *
+* NOS is distributed in the hope that it will be useful,                *
+* but WITHOUT ANY WARRANTY* without even the implied warranty of        *
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+* GNU Lesser General Public License for more details.                   *
+*                                                                       *
+* You should have received a copy of the GNU Lesser General Public      *
+* License along with NOS.  If not, see <http://www.gnu.org/licenses/>.  *
+************************************************************************/
+
+/*@file process.h
+* @author Ahmad Dajani <eng.adajani@gmail.com>
+* @date 19 Oct 2026
+* @brief Kernel process header file
+*/
+
+#ifndef __PROCESS_H
+    #define __PROCESS_H
+    #include <kernel/arena.h> /* Arena */
+    #include <kernel/context.h> /* Context */
+    #include <kernel/shared.h> /* SharedCode */
+    #include <kernel/swap.h> /* SwapImage */
+    #include <kernel/pheap.h> /* ParagraphHeap */
+
+    #define PROCESS_FILES 8 /* handles of API_FILE_OPEN */
+    #define PROCESS_VECTORS 8 /* INT 21h AH=25h vectors, restored when the process ends */
+
+    struct File;
+
+    /* the handler of an interrupt vector before the process first set it */
+    struct SavedVector {
+        unsigned int vector;
+        unsigned long handler;
+    };
+
+    struct Process {
+        unsigned int processId;
+        struct Arena arena; /* image, kernel objects and the heap chunks */
+        struct ParagraphHeap heap; /* API_MALLOC and INT 21h AH=48h blocks */
+        unsigned int imageSegment;
+        unsigned int imageParagraphs;
+        struct File far *files[PROCESS_FILES]; /* NULL for a free handle */
+        struct Context context; /* kernel stack at launch, resumed on exit */
+        int exitCode;
+        int childExitCode; /* INT 21h AH=4Dh, of the last AH=4Bh child */
+        struct SharedCode *sharedCode; /* NULL when the code is in the arena */
+        struct SwapImage far *swapImage; /* NULL while the arena is resident */
+        struct SavedVector vectors[PROCESS_VECTORS];
+        unsigned int vectorsCount;
+    };
+
+    struct Process far *createProcess(void);
+    void destroyProcess(struct Process far *process);
+    struct Process far *getCurrentProcess(void);
+    void setCurrentProcess(struct Process far *process);
+    void exitCurrentProcess(int exitCode);
+    int setProcessVector(struct Process far *process, unsigned int vector, unsigned long handler);
+#endif
\ No newline at end of file
@@ -0,0 +1,91 @@
+/************************************************************************
+* Copyright (C) 2020 by Ahmad Dajani                                    *
+*                                                                       *
+* This file is part of NOS.                                             *
+*                                                                       *
+* NOS is free software: you can redistribute it and/or modify it        *
+* under the terms of the GNU Lesser General Public License as published *
+* by the Free Software Foundation, either version 3 of the License, or  *
+* (at your option) any later version.                                   *
+*                                                                       *
+* NOS is distributed in the hope that it will be useful,                *
+* but WITHOUT ANY WARRANTY* without even the implied warranty of        *
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+* GNU Lesser General Public License for more details.                   *
+*                                                                       *
+* You should have received a copy of the GNU Lesser General Public      *
+* License along with NOS.  If not, see <http://www.gnu.org/licenses/>.  *
+************************************************************************/
+
+/*@file sched.h
+* @author Ahmad Dajani <eng.adajani@gmail.com>
+* @date 19 Oct 2026
+* @brief Kernel task scheduler header file
+*/
+
+#ifndef __SCHED_H
+    #define __SCHED_H
+    #include <kernel/context.h> /* Context */
+    #include <kernel/process.h> /* Process */
+    #include <conio.h> /* PRINT_STREAM */
+
+    #define SCHEDULER_TASKS 8
+    #define TASK_STACK_SIZE 512
+    #define SWAPPER_STACK_SIZE 1024 /* extended memory copies and logging */
+    #define TASK_FLAGS 0x0200 /* interrupts enabled */
+    #define TASK_TIME_SLICE 2 /* timer ticks before round-robin preemption */
+    #define USER_SEGMENT_LIMIT 0xa000 /* code above is BIOS, never preempted */
+
+    enum TASK_STATE {
+        TASK_UNUSED = 0,
+        TASK_READY,
+        TASK_RUNNING,
+        TASK_BLOCKED,
+        TASK_FINISHED
+    };
+
+    /* lower value runs first, idle runs only when nothing else is ready */
+    enum TASK_PRIORITY {
+        PRIORITY_HIGH = 0,
+        PRIORITY_NORMAL,
+        PRIORITY_LOW,
+        PRIORITY_IDLE,
+        TASK_PRIORITIES
+    };
+
+    struct Task {
+        unsigned int taskId;
+        char *name;
+        enum TASK_STATE state;
+        enum TASK_PRIORITY priority;
+        struct Context context;
+        void (*entry)(void *argument);
+        void *argument;
+        void far *stack; /* NULL for the boot task */
+        struct Process far *process; /* current process while the task runs */
+        struct Task *next; /* run queue or event waiters */
+        unsigned int sliceTicks; /* left before preemption */
+        unsigned long cpuTicks;
+        unsigned int switches; /* times switched in */
+    };
+
+    /* tasks waiting for an I/O completion */
+    struct Event {
+        struct Task *waiters;
+        unsigned int isSignaled; /* signaled without waiters, consumed by the next wait */
+    };
+
+    void initializeScheduler(void);
+    struct Task *createTask(char *name, void (*entry)(void *argument), void *argument, unsigned int stackSize,
+                            enum TASK_PRIORITY priority);
+    struct Task *getCurrentTask(void);
+    void yield(void);
+    void schedulerTick(unsigned int codeSegment);
+    unsigned int swapOutBlockedTasks(void);
+    void retrySwapIns(void);
+    void exitTask(void);
+    void waitEvent(struct Event *event);
+    void signalEvent(struct Event *event);
+    unsigned char waitKeyboard(void);
+    void dumpTasks(enum PRINT_STREAM stream);
+#endif
\ No newline at end of file
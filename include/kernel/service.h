@@ -26,22 +26,109 @@
 
 #ifndef __SERVICE_H
     #define __SERVICE_H
+    #include <conio.h> /* PRINT_STREAM */
 
-    /* #define SERVICE_DEBUG */
+    /* #define SERVICE_ENTRY_BENCHMARK */
     #define KERNEL_INTERRUPT 87
+    #define SERVICE_ENTRY_VECTOR 88 /* far pointer at 0000:0160, @see entry.asm */
+    #define SERVICE_ENTRY_CALLS 1000
     #define DOS_INTERRUPT 0x21
+    #define PROGRAM_TERMINATE_INTERRUPT 0x20
+    #define CARRY_FLAG 0x0001
+    #define KERNEL_STACK_SIZE 2048 /* file calls, @see callOnKernelStack */
+    #define FILE_PATH_SIZE 80
+
+    #define DOS_VERSION 0x1e03 /* 3.30, AL=major AH=minor */
+    #define DOS_FILE_HANDLE_BASE 5 /* 0-4 are stdin, stdout, stderr, aux and prn */
+    #define DOS_STDIN 0
+    #define DOS_STDOUT 1
+    #define DOS_STDERR 2
+    #define DOS_DEVICE_CONSOLE 0x83 /* AX=4400h: device, console input and output */
+
+    /* INT 21h error codes in AX when CF is set */
+    #define DOS_ERROR_INVALID_FUNCTION 1
+    #define DOS_ERROR_FILE_NOT_FOUND 2
+    #define DOS_ERROR_TOO_MANY_FILES 4
+    #define DOS_ERROR_ACCESS_DENIED 5
+    #define DOS_ERROR_INVALID_HANDLE 6
+    #define DOS_ERROR_INSUFFICIENT_MEMORY 8
+    #define DOS_ERROR_INVALID_BLOCK 9
+    #define DOS_ERROR_INVALID_FORMAT 11
 
     enum KERNEL_API {
         API_KERNEL_VERSION = 0,
         API_MALLOC = 1,
         API_FREE = 2,
-        API_STDOUT_PRINT = 3
+        API_STDOUT_PRINT = 3,
+        API_HEAP_STATISTICS = 4,
+        API_EXIT = 5,
+        API_YIELD = 6,
+        API_READ_CHARACTER = 7,
+        API_FILE_OPEN = 8,
+        API_FILE_READ = 9,
+        API_FILE_SEEK = 10,
+        API_FILE_CLOSE = 11,
+        API_FILE_STAT = 12,
+        API_SERVICE_STATISTICS = 13,
+        API_STDOUT_WRITE = 14, /* AL=stream, ES:BX=buffer, CX=length */
+        API_LOG_MASK = 15 /* AL=level, BL=subsystems, returns AL=previous mask */
+    };
+
+    #define KERNEL_SERVICES 16
+    #define SERVICE_NAME_SIZE 12
+    #define SERVICE_LATENCY_BUCKETS 12
+    #define SERVICE_LATENCY_FIRST_BOUND 16 /* PIT counts, every next bucket doubles */
+
+    /* the interrupt frame in the order of the interrupt function parameters,
+       the handlers change the registers returned to the caller */
+    struct ServiceRegisters {
+        unsigned int BP, DI, SI, DS, ES, DX, CX, BX, AX, IP, CS, FLAGS;
+    };
+
+    /* API_SERVICE_STATISTICS CX=function, ES:BX=struct ServiceStatistics,
+       CF is set when the function is not registered */
+    struct ServiceStatistics {
+        char name[SERVICE_NAME_SIZE];
+        unsigned long calls;
+        unsigned long totalLatency; /* PIT counts, @see getTimerDivisor */
+        unsigned long maximumLatency;
+        unsigned long histogram[SERVICE_LATENCY_BUCKETS];
+    };
+
+    struct KernelService {
+        void (*handler)(struct ServiceRegisters far *registers);
+        struct ServiceStatistics statistics;
+    };
+
+    /* file call registers, CF is set and AX=DOS error code on failure:
+       API_FILE_OPEN  ES:BX=path,                     returns AX=handle
+       API_FILE_READ  DX=handle, ES:BX=buffer, CX=size, returns AX=bytes read
+       API_FILE_SEEK  DX=handle, CX:BX=offset, AL=origin (0 start, 1 current, 2 end),
+                                                      returns DX:AX=position
+       API_FILE_CLOSE DX=handle
+       API_FILE_STAT  DX=handle, ES:BX=struct FileStatus */
+    struct FileRequest {
+        unsigned int function;
+        unsigned int handle;
+        void far *address;
+        unsigned int count;
+        unsigned long offset;
+        unsigned int origin;
+        unsigned long result;
+        unsigned int error; /* DOS error code */
     };
 
     void initializeInterrupt(void);
+    void dispatchService(struct ServiceRegisters far *registers);
+    void farServiceEntry(void);
+    void measureServiceEntry(enum PRINT_STREAM stream);
+    int registerService(unsigned int function, char *name, void (*handler)(struct ServiceRegisters far *registers));
+    int getServiceStatistics(unsigned int function, struct ServiceStatistics far *statistics);
+    void dumpServiceStatistics(enum PRINT_STREAM stream);
     void interrupt kernelInterruptHandler(unsigned int BP, unsigned int DI, unsigned int SI, unsigned int DS,
                                           unsigned int ES, unsigned int DX, unsigned int CX, unsigned int BX,
                                           unsigned int AX, unsigned int IP, unsigned int CS, unsigned int FLAGS);
+    void interrupt programTerminateHandler(void);
     void interrupt DOSInterruptHandler(unsigned int BP, unsigned int DI, unsigned int SI, unsigned int DS,
                                        unsigned int ES, unsigned int DX, unsigned int CX, unsigned int BX,
                                        unsigned int AX, unsigned int IP, unsigned int CS, unsigned int FLAGS);
@@ -0,0 +1,47 @@
+/************************************************************************
+* Copyright (C) 2020 by Ahmad Dajani                                    *
+*                                                                       *
+* This file is part of NOS.                                             *
+*                                                                       *
+* NOS is free software: you can redistribute it and/or modify it        *
+* under the terms of the GNU Lesser General Public License as published *
+* by the Free Software Foundation, either version 3 of the License, or  *
+* (at your option) any later version.                                   *
+*                                                                       *
+* NOS is distributed in the hope that it will be useful,                *
+* but WITHOUT ANY WARRANTY* without even the implied warranty of        *
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+* GNU Lesser General Public License for more details.                   *
+*                                                                       *
+* You should have received a copy of the GNU Lesser General Public      *
+* License along with NOS.  If not, see <http://www.gnu.org/licenses/>.  *
+************************************************************************/
+
+/*@file shared.h
+* @author Ahmad Dajani <eng.adajani@gmail.com>
+* @date 19 Oct 2026
+* @brief Shared code segments header file
+* @see include\kernel\nxe.h NXE_SHARED_CODE
+*/
+
+#ifndef __SHARED_H
+    #define __SHARED_H
+    #include <kernel/imgcache.h> /* ImageCacheKey */
+    #include <conio.h> /* PRINT_STREAM */
+
+    #define SHARED_CODE_ENTRIES 4
+
+    /* code of a running image, freed with its last instance */
+    struct SharedCode {
+        struct ImageCacheKey key;
+        void far *block; /* kmalloc_align, code at segment:0 */
+        unsigned int paragraphs;
+        unsigned int users; /* processes running this code, 0 for a free entry */
+    };
+
+    struct SharedCode *findSharedCode(struct ImageCacheKey *key);
+    struct SharedCode *createSharedCode(struct ImageCacheKey *key, unsigned int paragraphs);
+    void releaseSharedCode(struct SharedCode *sharedCode);
+    unsigned int getSharedCodeHits(void);
+    void dumpSharedCode(enum PRINT_STREAM stream);
+#endif
\ No newline at end of file
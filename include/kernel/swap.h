@@ -0,0 +1,50 @@
+/************************************************************************
+* Copyright (C) 2020 by Ahmad Dajani                                    *
+*                                                                       *
+* This file is part of NOS.                                             *
+*                                                                       *
+* NOS is free software: you can redistribute it and/or modify it        *
+* under the terms of the GNU Lesser General Public License as published *
+* by the Free Software Foundation, either version 3 of the License, or  *
+* (at your option) any later version.                                   *
+*                                                                       *
+* NOS is distributed in the hope that it will be useful,                *
+* but WITHOUT ANY WARRANTY* without even the implied warranty of        *
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+* GNU Lesser General Public License for more details.                   *
+*                                                                       *
+* You should have received a copy of the GNU Lesser General Public      *
+* License along with NOS.  If not, see <http://www.gnu.org/licenses/>.  *
+************************************************************************/
+
+/*@file swap.h
+* @author Ahmad Dajani <eng.adajani@gmail.com>
+* @date 19 Oct 2026
+* @brief Process swapping to extended memory header file
+*/
+
+#ifndef __SWAP_H
+    #define __SWAP_H
+    #include <conio.h> /* PRINT_STREAM */
+
+    struct Process;
+
+    /* a kmalloc block of the process arena, back at the same address on swap in */
+    struct SwappedRegion {
+        void far *address;
+        unsigned long size;
+        unsigned long storage; /* extended memory linear address */
+    };
+
+    struct SwapImage {
+        unsigned int regionsCount;
+        unsigned long bytes;
+        struct SwappedRegion regions[1]; /* regionsCount entries, sized by swapOutProcess */
+    };
+
+    int swapOutProcess(struct Process far *process);
+    int swapInProcess(struct Process far *process);
+    void discardSwapImage(struct Process far *process);
+    unsigned int getSwapIns(void);
+    void dumpSwapStatistics(enum PRINT_STREAM stream);
+#endif
\ No newline at end of file
@@ -0,0 +1,50 @@
+/************************************************************************
+* Copyright (C) 2020 by Ahmad Dajani                                    *
+*                                                                       *
+* This file is part of NOS.                                             *
+*                                                                       *
+* NOS is free software: you can redistribute it and/or modify it        *
+* under the terms of the GNU Lesser General Public License as published *
+* by the Free Software Foundation, either version 3 of the License, or  *
+* (at your option) any later version.                                   *
+*                                                                       *
+* NOS is distributed in the hope that it will be useful,                *
+* but WITHOUT ANY WARRANTY* without even the implied warranty of        *
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+* GNU Lesser General Public License for more details.                   *
+*                                                                       *
+* You should have received a copy of the GNU Lesser General Public      *
+* License along with NOS.  If not, see <http://www.gnu.org/licenses/>.  *
+************************************************************************/
+
+/*@file timer.h
+* @author Ahmad Dajani <eng.adajani@gmail.com>
+* @date 19 Oct 2026
+* @brief Kernel programmable interval timer header file
+*/
+
+#ifndef __TIMER_H
+    #define __TIMER_H
+
+    #define TIMER_INTERRUPT 0x08 /* IRQ0 */
+    #define TIMER_FREQUENCY 100 /* scheduler ticks per second */
+    #define TIMER_MINIMUM_FREQUENCY 19 /* divisor fits 16 bits */
+
+    #define PIT_FREQUENCY 1193182UL
+    #define PIT_CHANNEL0_PORT 0x40
+    #define PIT_COMMAND_PORT 0x43
+    #define PIT_CHANNEL0_RATE 0x34 /* channel 0, low/high byte, mode 2 (counts by one) */
+    #define PIT_CHANNEL0_LATCH 0x00
+    #define PIC_MASTER_PORT 0x20
+    #define PIC_END_OF_INTERRUPT 0x20
+    #define BIOS_TICK_PERIOD 0x10000UL /* PIT counts per BIOS tick (18.2Hz) */
+
+    void initializeTimer(void);
+    void setTimerFrequency(unsigned int hertz);
+    unsigned int getTimerDivisor(void);
+    unsigned long getTimerTicks(void);
+    unsigned int readTimerCounter(void);
+    void interrupt timerInterruptHandler(unsigned int BP, unsigned int DI, unsigned int SI, unsigned int DS,
+                                         unsigned int ES, unsigned int DX, unsigned int CX, unsigned int BX,
+                                         unsigned int AX, unsigned int IP, unsigned int CS, unsigned int FLAGS);
+#endif
\ No newline at end of file
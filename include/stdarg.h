@@ -30,10 +30,13 @@
         #define NULL 0
     #endif
 
-    typedef void *va_list;
+    /* far, the arguments are on SS and the interrupt handlers run with SS
+       other than DS */
+    typedef char far *va_list;
 
     #define __size(x)           ((sizeof(x)+sizeof(int)-1) & ~(sizeof(int)-1))
-    #define va_start(ap, parmN) ((void)((ap) = (va_list)((char *)(&parmN)+__size(parmN))))
-    #define va_arg(ap, type)    (*(type *)(((*(char **)&(ap))+=__size(type))-(__size(type))))
+    #define va_start(ap, parmN) ((void)((ap) = (va_list)(((unsigned long)_SS << 16) | \
+                                                         (unsigned int)((char *)(&parmN)+__size(parmN)))))
+    #define va_arg(ap, type)    ((ap) += __size(type), *(type far *)((ap) - __size(type)))
     #define va_end(ap)          ((void)NULL)
 #endif
\ No newline at end of file
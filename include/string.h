@@ -47,5 +47,6 @@
     void memset(void far *address, char value, size_t size);
     void movedata(unsigned SourceSegment, unsigned SourceOffset,
                   unsigned DestinationSegment, unsigned DestinationOffset, size_t size);
+    size_t getStringLength(char far *string);
     unsigned char convertCharacterToLowerCase(unsigned char character);
 #endif
\ No newline at end of file
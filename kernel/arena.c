@@ -0,0 +1,149 @@
+/************************************************************************
+* Copyright (C) 2020 by Ahmad Dajani                                    *
+*                                                                       *
+* This file is part of NOS.                                             *
+*                                                                       *
+* NOS is free software: you can redistribute it and/or modify it        *
+* under the terms of the GNU Lesser General Public License as published *
+* by the Free Software Foundation, either version 3 of the License, or  *
+* (at your option) any later version.                                   *
+*                                                                       *
+* NOS is distributed in the hope that it will be useful,                *
+* but WITHOUT ANY WARRANTY* without even the implied warranty of        *
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+* GNU Lesser General Public License for more details.                   *
+*                                                                       *
+* You should have received a copy of the GNU Lesser General Public      *
+* License along with NOS.  If not, see <http://www.gnu.org/licenses/>.  *
+************************************************************************/
+
+/*@file arena.c
+* @author Ahmad Dajani <eng.adajani@gmail.com>
+* @date 19 Oct 2026
+* @brief Kernel arena allocator source file
+* @note Objects are carved from regions allocated by kmalloc and are never
+*       freed one by one, the whole arena is released with one kfree per
+*       region: O(regions), not O(objects). The regions are separate heap
+*       blocks, placed by first fit and swapped one by one, so they are not
+*       cut off in one operation. An aligned allocation is a region of its
+*       own and can be freed with arenaFree.
+*/
+
+#include <kernel/arena.h>
+#include <kernel/memory.h> /* kmalloc, kmalloc_align, kfree */
+#include <kernel/disk.h> /* SUCCESS, FAILURE */
+#include <conio.h> /* printFormat */
+#include <string.h> /* NULL, FP_SEG, MK_FP */
+#include <kernel/log.h> /* logTrace */
+
+void initializeArena(struct Arena far *arena) {
+    arena->regions = NULL;
+    arena->bytesAllocated = 0;
+    arena->regionsCount = 0;
+}
+
+static void linkRegion(struct Arena far *arena, struct ArenaRegion far *region, unsigned int isHead) {
+    /* the head region is the only one used for carving, dedicated regions
+       are linked after it so the head keeps its free space */
+    if(isHead || arena->regions == NULL) {
+        region->next = arena->regions;
+        arena->regions = region;
+    }
+    else {
+        region->next = arena->regions->next;
+        arena->regions->next = region;
+    }
+    arena->regionsCount++;
+}
+
+static struct ArenaRegion far *createRegion(struct Arena far *arena, unsigned long size, unsigned int isHead) {
+    struct ArenaRegion far *region;
+
+    region = (struct ArenaRegion far *)kmalloc(sizeof(struct ArenaRegion) + size);
+    if(!region) {
+        return NULL;
+    }
+    region->size = size;
+    region->used = 0;
+    linkRegion(arena, region, isHead);
+
+    logTrace(LOG_MEM, ("arena: new region @ %x:%x\n", FP_SEG(region), FP_OFF(region)));
+    return region;
+}
+
+void far *arenaAllocate(struct Arena far *arena, unsigned long size) {
+    struct ArenaRegion far *region = arena->regions;
+    unsigned long address;
+
+    size = (size + 1) & ~1UL; /* word aligned */
+
+    if(region == NULL || region->size - region->used < size) {
+        if(size > ARENA_REGION_SIZE / 2) {
+            region = createRegion(arena, size, 0);
+        }
+        else {
+            region = createRegion(arena, ARENA_REGION_SIZE, 1);
+        }
+        if(!region) {
+            return NULL;
+        }
+    }
+
+    address = convertFarPointerToLinearAddress(region) + sizeof(struct ArenaRegion) + region->used;
+    region->used += size;
+    arena->bytesAllocated += size;
+    return convertLinearAddressToFarPointer(address);
+}
+
+void far *arenaAllocateAligned(struct Arena far *arena, unsigned long size) {
+    /* the region header takes the first paragraph, so the returned
+       address is segment:0 as kmalloc_align */
+    struct ArenaRegion far *region;
+
+    region = (struct ArenaRegion far *)kmalloc_align(size + 16);
+    if(!region) {
+        return NULL;
+    }
+    region->size = size;
+    region->used = size;
+    linkRegion(arena, region, 0);
+    arena->bytesAllocated += size;
+
+    logTrace(LOG_MEM, ("arena: aligned region @ %x:0\n", FP_SEG(region) + 1));
+    return MK_FP(FP_SEG(region) + 1, 0);
+}
+
+int arenaFree(struct Arena far *arena, void far *address) {
+    /* only for arenaAllocateAligned, the region header is the paragraph before */
+    struct ArenaRegion far *region = (struct ArenaRegion far *)MK_FP(FP_SEG(address) - 1, 0);
+    struct ArenaRegion far * far *link = &arena->regions;
+
+    while(*link != NULL && *link != region) {
+        link = &(*link)->next;
+    }
+    if(*link == NULL || FP_OFF(address) != 0) {
+        return FAILURE;
+    }
+    *link = region->next;
+    arena->regionsCount--;
+    arena->bytesAllocated -= region->size;
+
+    logTrace(LOG_MEM, ("arena: free aligned region @ %x:0\n", FP_SEG(address)));
+    kfree(region);
+    return SUCCESS;
+}
+
+void releaseArena(struct Arena far *arena) {
+    /* O(regions), one kfree per region, the carved objects are not visited */
+    struct ArenaRegion far *region = arena->regions;
+    struct ArenaRegion far *nextRegion;
+
+    logTrace(LOG_MEM, ("arena: release %d regions\n", arena->regionsCount));
+
+    while(region != NULL) {
+        nextRegion = region->next;
+        kfree(region);
+        region = nextRegion;
+    }
+    initializeArena(arena);
+}
\ No newline at end of file
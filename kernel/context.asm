@@ -0,0 +1,136 @@
+;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+; Copyright (C) 2020 by Ahmad Dajani                                    ;
+;                                                                       ;
+; This file is part of NOS.                                             ;
+;                                                                       ;
+; NOS is free software: you can redistribute it and/or modify it        ;
+; under the terms of the GNU Lesser General Public License as published ;
+; by the Free Software Foundation, either version 3 of the License, or  ;
+; (at your option) any later version.                                   ;
+;                                                                       ;
+; NOS is distributed in the hope that it will be useful,                ;
+; but WITHOUT ANY WARRANTY; without even the implied warranty of        ;
+; MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         ;
+; GNU Lesser General Public License for more details.                   ;
+;                                                                       ;
+; You should have received a copy of the GNU Lesser General Public      ;
+; License along with NOS.  If not, see <http://www.gnu.org/licenses/>.  ;
+;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+
+; @file context.asm
+; @author Ahmad Dajani <eng.adajani@gmail.com>
+; @date 19 Oct 2026
+; @brief Save and restore kernel execution context (setjmp/longjmp like)
+; @see include\kernel\context.h
+;
+; int saveContext(struct Context far *context);
+;     returns 0, and the value given to restoreContext when resumed
+; void restoreContext(struct Context far *context, int value);
+;     value must not be 0
+; int callOnKernelStack(int (*function)(void), void *stackTop);
+;     runs function with SS=DS and SP=stackTop unless SS=DS already,
+;     interrupt handlers run on the caller stack
+;
+public _saveContext
+public _restoreContext
+public _callOnKernelStack
+
+;struct Context offsets
+CONTEXT_SP    equ 0
+CONTEXT_BP    equ 2
+CONTEXT_SI    equ 4
+CONTEXT_DI    equ 6
+CONTEXT_IP    equ 8
+CONTEXT_SS    equ 10
+CONTEXT_DS    equ 12
+CONTEXT_ES    equ 14
+CONTEXT_FLAGS equ 16
+
+DGROUP group _text
+
+_text segment byte public USE16 'code'
+    assume cs:DGROUP
+    _saveContext proc near
+        push bp
+        mov bp, sp
+        push es
+        les bx, dword ptr [bp+4]
+
+        ;stack as seen after returning to the caller
+        lea ax, [bp+4]
+        mov es:[bx+CONTEXT_SP], ax
+        mov ax, [bp]
+        mov es:[bx+CONTEXT_BP], ax
+        mov ax, [bp+2]
+        mov es:[bx+CONTEXT_IP], ax
+        mov es:[bx+CONTEXT_SI], si
+        mov es:[bx+CONTEXT_DI], di
+        mov es:[bx+CONTEXT_SS], ss
+        mov es:[bx+CONTEXT_DS], ds
+        pop ax
+        mov es:[bx+CONTEXT_ES], ax
+        pushf
+        pop ax
+        mov es:[bx+CONTEXT_FLAGS], ax
+
+        xor ax, ax
+        pop bp
+        ret
+    _saveContext endp
+
+    _restoreContext proc near
+        push bp
+        mov bp, sp
+        mov ax, [bp+8]
+        les bx, dword ptr [bp+4]
+
+        cli
+            mov ss, es:[bx+CONTEXT_SS]
+            mov sp, es:[bx+CONTEXT_SP]
+            mov bp, es:[bx+CONTEXT_BP]
+            mov si, es:[bx+CONTEXT_SI]
+            mov di, es:[bx+CONTEXT_DI]
+            ;return to the caller of saveContext with the saved flags
+            push word ptr es:[bx+CONTEXT_IP]
+            push word ptr es:[bx+CONTEXT_FLAGS]
+            mov ds, es:[bx+CONTEXT_DS]
+            mov es, es:[bx+CONTEXT_ES]
+        popf
+        ret
+    _restoreContext endp
+
+    _callOnKernelStack proc near
+        push bp
+        mov bp, sp
+        mov bx, [bp+4]
+        mov cx, [bp+6]
+        mov ax, ss
+        mov dx, ds
+        cmp ax, dx
+        jne switchStack
+            call bx
+            pop bp
+            ret
+
+        switchStack:
+        pushf
+        mov dx, sp
+        cli
+            push ds
+            pop ss ;no interrupt before the next instruction
+            mov sp, cx
+        push ax ;caller stack
+        push dx
+        call bx
+        pop dx
+        pop cx
+        cli
+            mov ss, cx
+            mov sp, dx
+        popf
+        pop bp
+        ret
+    _callOnKernelStack endp
+_text ends
+
+end
\ No newline at end of file
@@ -25,6 +25,7 @@
 #include <kernel/disk.h>
 #include <string.h> /* FP_SEG, FP_OFF */
 #include <bios.h> /* CALL_DISKETTE_BIOS */
+#include <kernel/log.h> /* logWarning, logInfo, logTrace */
 
 static struct DiskParameters diskParameters;
 
@@ -88,33 +89,34 @@ int DiskOperationLBA(unsigned char operation, unsigned char numberOfSectors,
     head = (logicalBlockAddressing / diskParameters.sectorsPerTrack) % diskParameters.headsPerCylinder;
     sector = (logicalBlockAddressing % diskParameters.sectorsPerTrack) + 1;
 
-    #ifdef DISK_DEBUG
-        printFormat(LOGGER, "DiskOperationLBA lba=%d -> cylinder=%d, head=%d, sector=%d\n",
-                    logicalBlockAddressing, cylinder, head, sector);
-    #endif
+    logTrace(LOG_DISK, ("DiskOperationLBA lba=%d -> cylinder=%d, head=%d, sector=%d\n",
+                        logicalBlockAddressing, cylinder, head, sector));
 
     return DiskOperation(operation, numberOfSectors, cylinder, sector, head, drive, buffer);
 }
 
+/* sectors left on the track of lba, multi sector reads must not cross it */
+unsigned int getSectorsToTrackEnd(unsigned int logicalBlockAddressing) {
+    return diskParameters.sectorsPerTrack - (logicalBlockAddressing % diskParameters.sectorsPerTrack);
+}
+
 void initializeDisk(unsigned char drive) {
-    #ifdef DISK_DEBUG
+    int status;
+    #if LOG_LEVEL >= LOG_INFO
         static char *bootDrive[] = {"floppy a", "floppy b", "harddisk 0", "harddisk 1"};
-        int status=0;
-        printFormat(LOGGER, "Booting from %s\n", bootDrive[drive]);
-    #endif
-    
-    (void)resetDisk(drive);
-    #ifdef DISK_DEBUG
-        /* _AX contains the return value from the previous function */
-        printFormat(LOGGER, "resetDisk status = %d\n", _AX);
     #endif
+    logInfo(LOG_DISK, ("Booting from %s\n", bootDrive[drive]));
 
-    (void)getDiskParameters(&diskParameters, drive);
-    #ifdef DISK_DEBUG
-        printFormat(LOGGER, "getDiskParameters status = %d\n", _AX);
-        if(status == SUCCESS) {
-            printFormat(LOGGER, " headsPerCylinder=%d\n", diskParameters.headsPerCylinder);
-            printFormat(LOGGER, " sectorsPerTrack=%d\n", diskParameters.sectorsPerTrack);
-        }
-    #endif
+    status = resetDisk(drive);
+    if(status != SUCCESS) {
+        logWarning(LOG_DISK, ("resetDisk status = %d\n", status));
+    }
+
+    status = getDiskParameters(&diskParameters, drive);
+    if(status != SUCCESS) {
+        logWarning(LOG_DISK, ("getDiskParameters status = %d\n", status));
+        return;
+    }
+    logInfo(LOG_DISK, (" headsPerCylinder=%d\n", diskParameters.headsPerCylinder));
+    logInfo(LOG_DISK, (" sectorsPerTrack=%d\n", diskParameters.sectorsPerTrack));
 }
\ No newline at end of file
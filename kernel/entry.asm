@@ -0,0 +1,84 @@
+;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+; Copyright (C) 2020 by Ahmad Dajani                                    ;
+;                                                                       ;
+; This file is part of NOS.                                             ;
+;                                                                       ;
+; NOS is free software: you can redistribute it and/or modify it        ;
+; under the terms of the GNU Lesser General Public License as published ;
+; by the Free Software Foundation, either version 3 of the License, or  ;
+; (at your option) any later version.                                   ;
+;                                                                       ;
+; NOS is distributed in the hope that it will be useful,                ;
+; but WITHOUT ANY WARRANTY; without even the implied warranty of        ;
+; MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         ;
+; GNU Lesser General Public License for more details.                   ;
+;                                                                       ;
+; You should have received a copy of the GNU Lesser General Public      ;
+; License along with NOS.  If not, see <http://www.gnu.org/licenses/>.  ;
+;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
+; @file entry.asm
+; @author Ahmad Dajani <eng.adajani@gmail.com>
+; @date 19 Oct 2026
+; @brief Far call entry of the kernel services
+; @see include\kernel\service.h
+;
+; farServiceEntry
+;     reached with CALL FAR from the programs (the far pointer is in the
+;     SERVICE_ENTRY_VECTOR slot of the vector table), same registers as
+;     the kernel interrupt. The return address is moved under the flags
+;     so the stack holds the frame of kernelInterruptHandler, the handler
+;     runs through dispatchService and IRET returns with the new flags
+;
+public _farServiceEntry
+extrn _dispatchService:near
+
+DGROUP group _text
+
+_text segment byte public USE16 'code'
+    assume cs:DGROUP
+    _farServiceEntry proc near
+        pushf
+        cli
+        push ax
+        push bp
+        mov bp, sp
+        ;[bp+4]=flags [bp+6]=ip [bp+8]=cs to ip, cs, flags
+        mov ax, [bp+4]
+        xchg ax, [bp+8]
+        xchg ax, [bp+6]
+        mov [bp+4], ax
+        pop bp
+        pop ax
+
+        ;same order as the interrupt function prologue
+        push ax
+        push bx
+        push cx
+        push dx
+        push es
+        push ds
+        push si
+        push di
+        push bp
+        mov ax, cs ;tiny model, DS=CS
+        mov ds, ax
+        mov bp, sp
+        cld
+        push ss ;struct ServiceRegisters far *
+        push bp
+        call _dispatchService
+        add sp, 4
+        pop bp
+        pop di
+        pop si
+        pop ds
+        pop es
+        pop dx
+        pop cx
+        pop bx
+        pop ax
+        iret
+    _farServiceEntry endp
+_text ends
+
+end
\ No newline at end of file
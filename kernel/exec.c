@@ -24,98 +24,511 @@
 */
 
 #include <kernel/exec.h> /*  */
-#include <kernel/filesys.h> /* fopen, fclose, loadFile */
-#include <string.h> /* NULL */
-#include <kernel/memory.h> /* kmalloc */
-#ifdef EXEC_DEBUG
-    #include <kernel/debug.h>
-#endif
-
-/* single task process execution 
-   @return <0 error message
-           >=0 process return value
-*/
-int executeBinary(char *path) {
-    static unsigned int _cs_, _ip_, _ss_, _sp_;
-    static unsigned char far *buffer = NULL;
-    struct ExecutableFile far *header = NULL;
-    int value = 0;
-    struct File far *file;
-    unsigned int imageBase;
-    unsigned long align;
+#include <kernel/nxe.h> /* NativeExecutableFile */
+#include <kernel/nxeload.h> /* unpackImage, relocateNativeImage */
+#include <kernel/filesys.h> /* fopen, fclose, readFile, openPath */
+#include <kernel/imgcache.h> /* findCachedImage, cacheImage */
+#include <kernel/shared.h> /* findSharedCode, createSharedCode, getSharedCodeHits */
+#include <string.h> /* NULL, memset, getStringLength, movedata, convertCharacterToLowerCase */
+#include <kernel/memory.h> /* dumpHeapStatistics */
+#include <kernel/process.h> /* createProcess, destroyProcess */
+#include <kernel/swap.h> /* getSwapIns, dumpSwapStatistics */
+#include <kernel/context.h> /* saveContext */
+#include <kernel/sched.h> /* swapOutBlockedTasks, retrySwapIns, createTask, waitEvent, signalEvent */
+#include <kernel/log.h> /* logWarning, logTrace, isLogEnabled */
+#include <kernel/debug.h> /* DebugBreak */
+
+static unsigned char sectorBuffer[SECTOR_SIZE]; /* MZ relocations */
+static struct ProgramTask programs[PROGRAM_TASKS];
+
+static unsigned long getLoadModuleSize(struct ExecutableFile *header) {
+    /* file size in pages, the last page holds imageLength bytes */
+    unsigned long size = (unsigned long)header->fileSize * SECTOR_SIZE;
+    if(header->imageLength) {
+        size -= SECTOR_SIZE - header->imageLength;
+    }
+    return size - ((unsigned long)header->headerSize << 4);
+}
+
+static unsigned int isExeHeaderValid(struct ExecutableFile *header, unsigned long fileSize) {
+    /* the sizes getLoadModuleSize subtracts are checked first, a corrupt
+       header would otherwise wrap around to a huge load module */
+    unsigned long size = (unsigned long)header->fileSize * SECTOR_SIZE;
+
+    if(header->signature != EXE_SIGNATURE || header->fileSize == 0 || header->imageLength >= SECTOR_SIZE) {
+        return 0;
+    }
+    if(header->imageLength) {
+        size -= SECTOR_SIZE - header->imageLength;
+    }
+    return ((unsigned long)header->headerSize << 4) <= size && size <= fileSize;
+}
+
+static int relocateImage(struct File far *file, struct CachedImage *cachedImage,
+                         struct ExecutableFile *header, unsigned int imageBase) {
+    /* the relocation table is read one sector at a time, from the file when
+       it is open (and stored in the cache if any), otherwise from the cache */
+    struct RelocationTable *relocations = (struct RelocationTable *)sectorBuffer;
+    unsigned int firstItem = 0;
+    unsigned int count;
+    unsigned int index;
     unsigned int far *addressFixup;
-    struct RelocationTable far *relocationTable;
 
-    #ifdef EXEC_DEBUG
-    printFormat(LOGGER, "executeBinary\n");
-    #endif
+    logTrace(LOG_EXEC, ("\tEXE: relocation of %d items\n", header->relocationItems));
+    while(firstItem < header->relocationItems) {
+        count = header->relocationItems - firstItem;
+        if(count > SECTOR_SIZE / sizeof(struct RelocationTable)) {
+            count = SECTOR_SIZE / sizeof(struct RelocationTable);
+        }
+        if(file) {
+            if(readFile(file, header->relocationItemOffset + (unsigned long)firstItem * sizeof(struct RelocationTable),
+                        (void far *)relocations, (unsigned long)count * sizeof(struct RelocationTable)) !=
+               (unsigned long)count * sizeof(struct RelocationTable)) {
+                return 0;
+            }
+            if(cachedImage && writeCachedRelocations(cachedImage, firstItem, relocations, count) != SUCCESS) {
+                return 0;
+            }
+        }
+        else if(readCachedRelocations(cachedImage, firstItem, relocations, count) != SUCCESS) {
+            return 0;
+        }
+
+        for(index = 0; index < count; index++) {
+            addressFixup = (unsigned int far *)MK_FP(relocations[index].segment + imageBase,
+                                                     relocations[index].offset);
+            *addressFixup += imageBase;
+        }
+        firstItem += count;
+    }
+    return 1;
+}
+
+static void initializeProgramSegmentPrefix(unsigned int segment, unsigned int memoryTop) {
+    /* what the DOS runtime startup reads: memory top, an empty environment
+       and an empty command line */
+    struct ProgramSegmentPrefix far *programSegmentPrefix;
+
+    programSegmentPrefix = (struct ProgramSegmentPrefix far *)MK_FP(segment, 0);
+    memset(programSegmentPrefix, NULL, sizeof(struct ProgramSegmentPrefix));
+    programSegmentPrefix->exitCall[0] = 0xcd; /* INT 20h */
+    programSegmentPrefix->exitCall[1] = 0x20;
+    programSegmentPrefix->memoryTop = memoryTop;
+    programSegmentPrefix->environmentSegment = segment + ENVIRONMENT_PARAGRAPH;
+    programSegmentPrefix->environment[2] = 1; /* one string follows, the empty program name */
+    programSegmentPrefix->commandLine[0] = '\r';
+}
+
+static unsigned char far *allocateImage(struct Process far *process, unsigned long loadModuleSize,
+                                        unsigned int minParagraphs, int isPrefixed) {
+    /* the PSP takes the first paragraphs when isPrefixed, the returned
+       image starts after it */
+    unsigned int prefixParagraphs = isPrefixed ? PROGRAM_SEGMENT_PREFIX_PARAGRAPHS : 0;
+    unsigned long imageSize = ((unsigned long)prefixParagraphs << 4) + ((loadModuleSize + 15) & ~15UL) +
+                              ((unsigned long)minParagraphs << 4);
+    unsigned char far *image = (unsigned char far *)arenaAllocateAligned(&process->arena, imageSize);
+    if(!image && swapOutBlockedTasks()) {
+        image = (unsigned char far *)arenaAllocateAligned(&process->arena, imageSize);
+    }
+    if(!image) {
+        return NULL;
+    }
+    process->imageSegment = FP_SEG(image); /* INT 21h AH=4Ah */
+    process->imageParagraphs = (unsigned int)(imageSize >> 4);
+    if(isPrefixed) {
+        initializeProgramSegmentPrefix(FP_SEG(image), FP_SEG(image) + process->imageParagraphs);
+    }
+    return (unsigned char far *)MK_FP(FP_SEG(image) + prefixParagraphs, 0);
+}
+
+static int loadNativeImage(struct File far *file, struct ImageCacheKey *key, struct Process far *process,
+                           struct ExecutableFile *header, unsigned char far **image, enum IMAGE_TYPE *imageType) {
+    /* header sectors, then the load module straight to its segment,
+       packed modules are expanded in place while they are read
+       @note the entry point is returned in the MZ header fields, for shared
+             code images the image is the private data and the segments are
+             relative to it */
+    static struct NativeExecutableFile nativeHeader;
+    struct SharedCode *sharedCode = NULL;
+    unsigned long moduleOffset;
+    unsigned long storedSize;
+    unsigned long codeSize = 0;
+    unsigned int codeBase;
+    unsigned int dataBase;
+    int isCodeLoaded = 0;
+    int isLoaded;
+
+    if(readFile(file, 0, (void far *)&nativeHeader, sizeof(struct NativeExecutableFile)) !=
+       sizeof(struct NativeExecutableFile) || nativeHeader.version != NXE_VERSION) {
+        printFormat(STDOUT, "\tNot valid nxe header\n");
+        return -2;
+    }
+    moduleOffset = (unsigned long)nativeHeader.headerSectors * SECTOR_SIZE;
+    storedSize = (nativeHeader.flags & NXE_COMPRESSED) ? nativeHeader.packedSize : nativeHeader.loadModuleSize;
+    if(!(nativeHeader.flags & NXE_SHARED_CODE)) {
+        nativeHeader.codeParagraphs = 0;
+    }
+    codeSize = (unsigned long)nativeHeader.codeParagraphs << 4;
+    if(moduleOffset + storedSize > file->size || codeSize >= nativeHeader.loadModuleSize) {
+        printFormat(STDOUT, "\tNot valid nxe header\n");
+        return -2;
+    }
+
+    /* another instance may run the code already */
+    if(codeSize && key && !(nativeHeader.flags & NXE_COMPRESSED)) {
+        sharedCode = findSharedCode(key);
+        isCodeLoaded = sharedCode != NULL;
+        if(!sharedCode) {
+            sharedCode = createSharedCode(key, nativeHeader.codeParagraphs);
+        }
+        process->sharedCode = sharedCode; /* released with the process */
+    }
+
+    if(!*image) {
+        *image = allocateImage(process, nativeHeader.loadModuleSize - (sharedCode ? codeSize : 0),
+                               nativeHeader.minParagraphs, sharedCode == NULL);
+        if(!*image) {
+            return -3;
+        }
+    }
+
+    logTrace(LOG_EXEC, ("\tNXE load module %x bytes @ %x:0, linked for %x, code %x paragraphs %s\n",
+                        (unsigned int)nativeHeader.loadModuleSize, FP_SEG(*image), nativeHeader.linkedBase,
+                        nativeHeader.codeParagraphs, isCodeLoaded ? "shared" : "loaded"));
+
+    if(sharedCode) {
+        codeBase = FP_SEG(sharedCode->block);
+        dataBase = FP_SEG(*image);
+        isLoaded = (isCodeLoaded || readFile(file, moduleOffset, sharedCode->block, codeSize) == codeSize) &&
+                   readFile(file, moduleOffset + codeSize, *image, storedSize - codeSize) == storedSize - codeSize;
+    }
+    else {
+        codeBase = FP_SEG(*image);
+        dataBase = codeBase + nativeHeader.codeParagraphs;
+        if(nativeHeader.flags & NXE_COMPRESSED) {
+            isLoaded = unpackImage(file, moduleOffset, storedSize, *image, nativeHeader.loadModuleSize);
+        }
+        else {
+            isLoaded = readFile(file, moduleOffset, *image, storedSize) == storedSize;
+        }
+    }
+    if(!isLoaded || !relocateNativeImage(file, &nativeHeader, codeBase, dataBase, !isCodeLoaded)) {
+        printFormat(STDOUT, "\tCan't load nxe image\n");
+        return -2;
+    }
+
+    if(codeSize) {
+        /* the program takes DS=ES from the loader */
+        *imageType = IMAGE_SHARED_NXE;
+        *image = (unsigned char far *)MK_FP(dataBase, 0);
+    }
+    header->minParagraphs = nativeHeader.minParagraphs;
+    header->stackSegment = nativeHeader.stackSegment - nativeHeader.codeParagraphs;
+    header->stackPointer = nativeHeader.stackPointer;
+    header->codeSegment = codeBase + nativeHeader.codeSegment - dataBase;
+    header->instructionPointer = nativeHeader.instructionPointer;
+    return 0;
+}
+
+static int isComFile(struct File far *file) {
+    return convertCharacterToLowerCase(file->extension[0]) == 'c' &&
+           convertCharacterToLowerCase(file->extension[1]) == 'o' &&
+           convertCharacterToLowerCase(file->extension[2]) == 'm';
+}
+
+static int loadComImage(struct File far *file, struct Process far *process, struct ExecutableFile *header,
+                        unsigned char far **image) {
+    /* one 64KB segment: PSP, the image at 0x100 and the stack at the top,
+       no header and no fixups */
+    unsigned int segment;
+
+    if(file->size > COM_MAX_SIZE) {
+        printFormat(STDOUT, "\tCom file is too big\n");
+        return -2;
+    }
+
+    *image = (unsigned char far *)arenaAllocateAligned(&process->arena, 0x10000UL);
+    if(!*image) {
+        return -3;
+    }
+    segment = FP_SEG(*image);
+    process->imageSegment = segment;
+    process->imageParagraphs = 0x1000;
+
+    logTrace(LOG_EXEC, ("\tCOM %x bytes @ %x:%x\n", (unsigned int)file->size, segment, COM_LOAD_OFFSET));
+
+    if(readFile(file, 0, MK_FP(segment, COM_LOAD_OFFSET), file->size) != file->size) {
+        printFormat(STDOUT, "\tCan't load com image\n");
+        return -2;
+    }
+
+    initializeProgramSegmentPrefix(segment, segment + 0x1000);
+
+    /* RET from the program jumps to PSP:0 */
+    *(unsigned int far *)MK_FP(segment, COM_STACK_POINTER) = 0;
+
+    header->minParagraphs = 0;
+    header->stackSegment = 0;
+    header->stackPointer = COM_STACK_POINTER;
+    header->codeSegment = 0;
+    header->instructionPointer = COM_LOAD_OFFSET;
+    return 0;
+}
+
+static int loadImage(char *path, struct Process far *process, struct ExecutableFile *header,
+                     unsigned char far **image, enum IMAGE_TYPE *imageType) {
+    /* read the image from the disk and keep a pristine copy in the cache
+       @return 0 or the executeBinary error */
+    static struct ImageCacheKey key;
+    struct FileInformation far *fileInformation;
+    struct CachedImage *cachedImage = NULL;
+    struct File far *file;
+    unsigned long loadModuleSize;
+    int isKeyValid;
+    int isHeaderRead;
+    int value;
+
+    *imageType = IMAGE_MZ;
+    fileInformation = openPath(path);
+    if(!fileInformation) {
+        logWarning(LOG_EXEC, ("\tFile not found\n"));
+        return -1;
+    }
+
+    isKeyValid = makeImageCacheKey(&key, path, fileInformation);
+    if(isKeyValid) {
+        cachedImage = findCachedImage(&key);
+    }
+    if(cachedImage) {
+        *header = cachedImage->header;
+        *image = allocateImage(process, getLoadModuleSize(header), header->minParagraphs, 1);
+        if(!*image) {
+            return -3;
+        }
+        if(loadCachedImage(cachedImage, *image) == SUCCESS &&
+           relocateImage(NULL, cachedImage, header, FP_SEG(*image))) {
+            return 0;
+        }
+        /* the copy in the cache is not usable, load it from the disk with
+           the image sized by the header read there */
+        dropCachedImage(cachedImage);
+        cachedImage = NULL;
+        arenaFree(&process->arena, *image);
+        *image = NULL;
+        process->imageSegment = 0;
+        process->imageParagraphs = 0;
+    }
 
     file = fopen(path);
     if(!file) {
-        #ifdef EXEC_DEBUG
-        printFormat(LOGGER, "\tFile not found\n");
-        #endif
         return -1;
     }
 
-    /* size is sector aligned */
-    align = SECTOR_SIZE - (file->size % SECTOR_SIZE);
-    buffer = (unsigned char far *)kmalloc_align(file->size + align);
-
-    /* load the file into allocated buffer */
-    loadFile(file, buffer);
+    isHeaderRead = readFile(file, 0, (void far *)header, sizeof(struct ExecutableFile)) ==
+                   sizeof(struct ExecutableFile);
+    if(isHeaderRead && header->signature == NXE_SIGNATURE) {
+        *imageType = IMAGE_NXE;
+        value = loadNativeImage(file, isKeyValid ? &key : NULL, process, header, image, imageType);
+        fclose(file);
+        return value;
+    }
 
-    #ifdef EXEC_DEBUG
-    printFormat(LOGGER, "\tEXE located @ %x:%x\n", FP_SEG(buffer), FP_OFF(buffer));
-    #endif
+    /* as DOS, a com file with MZ signature is an exe */
+    if((!isHeaderRead || header->signature != EXE_SIGNATURE) && isComFile(file)) {
+        *imageType = IMAGE_COM;
+        value = loadComImage(file, process, header, image);
+        fclose(file);
+        return value;
+    }
 
-    header = (struct ExecutableFile far *)buffer;
-    if(header->signature != EXE_SIGNATURE) {
+    if(!isHeaderRead || !isExeHeaderValid(header, file->size)) {
         printFormat(STDOUT, "\tNot valid exe header\n");
         fclose(file);
-        kfree(buffer);
         return -2;
     }
-    //fclose(file);
 
-    #ifdef EXEC_DEBUG
-    printFormat(LOGGER, "\tEXE: relocation\n");
+    *image = allocateImage(process, getLoadModuleSize(header), header->minParagraphs, 1);
+    if(!*image) {
+        fclose(file);
+        return -3;
+    }
+    loadModuleSize = getLoadModuleSize(header);
+
+    logTrace(LOG_EXEC, ("\tEXE load module %x bytes @ %x:0, min paragraphs %x\n",
+                        (unsigned int)loadModuleSize, FP_SEG(*image), header->minParagraphs));
+
+    if(readFile(file, (unsigned long)header->headerSize << 4, *image, loadModuleSize) != loadModuleSize) {
+        printFormat(STDOUT, "\tCan't load exe image\n");
+        fclose(file);
+        return -2;
+    }
+
+    if(isKeyValid) {
+        cachedImage = cacheImage(&key, header, *image, loadModuleSize);
+    }
+    if(!relocateImage(file, cachedImage, header, FP_SEG(*image))) {
+        if(cachedImage) {
+            dropCachedImage(cachedImage);
+        }
+        printFormat(STDOUT, "\tCan't load exe image\n");
+        fclose(file);
+        return -2;
+    }
+    fclose(file);
+    return 0;
+}
+
+/* single task process execution, returns when the process exits
+   @return <0 error message
+           >=0 process return value
+   @note only the header is read first, the load module is streamed to its
+         final segment and the allocation is load module + minParagraphs.
+         Recently used images are copied from the image cache instead.
+         Com files get a 64KB segment with a PSP and no fixups, MZ and
+         private NXE images get a PSP before the load module.
+         Shared code NXE images load their code once for all the instances.
+*/
+int executeBinary(char *path) {
+    static unsigned int _cs_, _ip_, _ss_, _sp_, _ds_;
+    static struct ExecutableFile header;
+    enum IMAGE_TYPE imageType;
+    unsigned char far *image = NULL;
+    int value = 0;
+    unsigned int imageBase;
+    struct Process far *process;
+
+    logTrace(LOG_EXEC, ("executeBinary\n"));
+
+    process = createProcess();
+    if(!process) {
+        return -3;
+    }
+
+    value = loadImage(path, process, &header, &image, &imageType);
+    if(value < 0) {
+        destroyProcess(process);
+        return value;
+    }
+    imageBase = FP_SEG(image);
+
+    _cs_ = header.codeSegment + imageBase;
+    _ip_ = header.instructionPointer;
+    _ss_ = header.stackSegment + imageBase;
+    _sp_ = header.stackPointer;
+
+    logTrace(LOG_EXEC, ("\tExe segments: ss:%x, sp:%x, cs:%x, ip:%x\n", _ss_, _sp_, _cs_, _ip_));
+    #if LOG_LEVEL >= LOG_TRACE
+    if(isLogEnabled(LOG_TRACE, LOG_MEM)) {
+        dumpHeapStatistics(LOGGER);
+    }
     #endif
-    /* exe relocation */
-    imageBase = FP_SEG(buffer) + header->headerSize;
-    while(header->relocationItems--) {
-        relocationTable = (struct RelocationTable far *)MK_FP(FP_SEG(buffer), header->relocationItemOffset);
-        relocationTable->segment += imageBase;
-
-        addressFixup = (unsigned int far *)MK_FP(relocationTable->segment, relocationTable->offset);
-        #ifdef EXEC_DEBUG
-        printFormat(LOGGER, "\tItem #%d @ %x:%x=%x,",
-                    header->relocationItems, relocationTable->segment,relocationTable->offset, *addressFixup);
-        #endif
-        *addressFixup += imageBase;
-        #ifdef EXEC_DEBUG
-        printFormat(LOGGER, "address fixup=%x\n", *addressFixup);
-        #endif
-        /* Advanced to the next item */
-        header->relocationItemOffset += sizeof(struct RelocationTable);
-    }
-    header->stackSegment += imageBase;
-    header->codeSegment += imageBase;
-
-    _cs_ = header->codeSegment;
-    _ip_ = header->instructionPointer;
-    _ss_ = header->stackSegment;
-    _sp_ = header->stackPointer;
-
-    #ifdef EXEC_DEBUG
-    printFormat(LOGGER, "\tExe segments: ss:%x, sp:%x, cs:%x, ip:%x\n",
-                _ss_, _sp_, _cs_, _ip_);
     DebugBreak();
-    #endif
 
-    /* TODO: store returned address */
-    FAR_JUMP(_ss_, _sp_, _cs_, _ip_);
+    /* exitCurrentProcess resumes here with 1 */
+    if(saveContext(&process->context) == 0) {
+        setCurrentProcess(process);
+        /* as DOS, DS=ES=PSP, shared code images take their data segment */
+        _ds_ = imageType == IMAGE_SHARED_NXE ? imageBase : process->imageSegment;
+        FAR_JUMP_WITH_DATA(_ss_, _sp_, _cs_, _ip_, _ds_);
+    }
 
-    /* kfree(buffer); */
+    value = process->exitCode;
+    destroyProcess(process);
+    retrySwapIns(); /* the swap ins deferred for this memory */
+    logTrace(LOG_EXEC, ("\tProcess exit code %d\n", value));
+    #if LOG_LEVEL >= LOG_TRACE
+    if(isLogEnabled(LOG_TRACE, LOG_MEM)) {
+        dumpHeapStatistics(LOGGER);
+    }
+    #endif
     return value;
-}
\ No newline at end of file
+}
+
+static void programTask(void *argument) {
+    /* executeBinary and the file system need a stack in the kernel segment,
+       so every program runs on one of these tasks, not on its parent stack */
+    struct ProgramTask *program = (struct ProgramTask *)argument;
+    while(1) {
+        waitEvent(&program->start);
+        program->exitCode = executeBinary(program->path);
+        program->state = PROGRAM_FINISHED;
+        signalEvent(&program->finished);
+    }
+}
+
+void initializePrograms(void) {
+    /* the tasks are created at boot, so their stacks are in the kernel segment */
+    static char *names[PROGRAM_TASKS] = {"program0", "program1", "program2"};
+    register unsigned int index;
+    memset((void far *)programs, NULL, sizeof(programs));
+    for(index = 0; index < PROGRAM_TASKS; index++) {
+        programs[index].task = createTask(names[index], programTask, &programs[index], PROGRAM_STACK_SIZE,
+                                          PRIORITY_NORMAL);
+        if(!programs[index].task) {
+            logWarning(LOG_EXEC, ("Can't create the %s task\n", names[index]));
+        }
+    }
+}
+
+/* start a program beside the current task
+   @return the program for waitProgram, -1 when every program task is busy */
+int spawnProgram(char *path) {
+    register unsigned int index;
+    unsigned int length = getStringLength(path);
+    if(length >= FILE_PATH_SIZE) {
+        return -1;
+    }
+    for(index = 0; index < PROGRAM_TASKS; index++) {
+        if(programs[index].task && programs[index].state == PROGRAM_FREE) {
+            movedata(_DS, (unsigned int)path, _DS, (unsigned int)programs[index].path, length + 1);
+            programs[index].state = PROGRAM_RUNNING;
+            programs[index].finished.isSignaled = 0;
+            logTrace(LOG_EXEC, ("spawn %s on %s\n", path, programs[index].task->name));
+            signalEvent(&programs[index].start);
+            return index;
+        }
+    }
+    return -1;
+}
+
+/* block the current task until the program ends, the program is free again
+   @return as executeBinary */
+int waitProgram(unsigned int program) {
+    if(program >= PROGRAM_TASKS || programs[program].state == PROGRAM_FREE) {
+        return -1;
+    }
+    if(programs[program].state == PROGRAM_RUNNING) {
+        waitEvent(&programs[program].finished);
+    }
+    programs[program].state = PROGRAM_FREE;
+    return programs[program].exitCode;
+}
+
+#ifdef EXEC_SELF_TEST
+void testPrograms(enum PRINT_STREAM stream) {
+    /* two instances of system\twin.nxe at once, the second one finds the
+       code of the first one. Each one checks its data, @see twin.asm */
+    static char *twinPath = "/system     /twin    nxe";
+    static char *hogPath = "/system     /hog     nxe";
+    unsigned int hits = getSharedCodeHits();
+    unsigned int swapIns;
+    int first = spawnProgram(twinPath);
+    int second = spawnProgram(twinPath);
+    int firstValue = first < 0 ? first : waitProgram(first);
+    int secondValue = second < 0 ? second : waitProgram(second);
+
+    hits = getSharedCodeHits() - hits;
+    printFormat(stream, "Programs: twin returned %d and %d, shared code hits %d, %s\n", firstValue, secondValue,
+                hits, firstValue == 0 && secondValue == 0 && hits == 1 ? "passed" : "FAILED");
+
+    /* hog fills the memory and runs twin with INT 21h AH=4Bh, twin loads
+       once the blocked hog is swapped out, @see hog.asm */
+    swapIns = getSwapIns();
+    first = spawnProgram(hogPath);
+    firstValue = first < 0 ? first : waitProgram(first);
+    swapIns = getSwapIns() - swapIns;
+    printFormat(stream, "Programs: hog returned %d, %d swap ins, %s\n", firstValue, swapIns,
+                firstValue == 0 && swapIns ? "passed" : "FAILED");
+    dumpSwapStatistics(stream);
+}
+#endif
\ No newline at end of file
@@ -0,0 +1,237 @@
+/************************************************************************
+* Copyright (C) 2020 by Ahmad Dajani                                    *
+*                                                                       *
+* This file is part of NOS.                                             *
+*                                                                       *
+* NOS is free software: you can redistribute it and/or modify it        *
+* under the terms of the GNU Lesser General Public License as published *
+* by the Free Software Foundation, either version 3 of the License, or  *
+* (at your option) any later version.                                   *
+*                                                                       *
+* NOS is distributed in the hope that it will be useful,                *
+* but WITHOUT ANY WARRANTY* without even the implied warranty of        *
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+* GNU Lesser General Public License for more details.                   *
+*                                                                       *
+* You should have received a copy of the GNU Lesser General Public      *
+* License along with NOS.  If not, see <http://www.gnu.org/licenses/>.  *
+************************************************************************/
+
+/*@file extmem.c
+* @author Ahmad Dajani <eng.adajani@gmail.com>
+* @date 19 Oct 2026
+* @brief Extended memory (above 1MB) manager source file
+* @note The block list lives in conventional memory, the managed memory
+*       is only touched by INT 15h AH=87h block moves.
+*/
+
+#include <kernel/extmem.h>
+#include <kernel/memory.h> /* convertFarPointerToLinearAddress */
+#include <kernel/hma.h> /* isHighMemoryAvailable, enableA20 */
+#include <kernel/disk.h> /* SUCCESS, FAILURE */
+#include <bios.h> /* CALL_SYSTEM_BIOS */
+#include <conio.h> /* printFormat */
+#include <string.h> /* memset, FP_SEG, FP_OFF */
+#include <kernel/log.h> /* logError, logWarning, logTrace, isLogEnabled */
+
+static struct ExtendedMemoryBlock blocks[EXTENDED_MEMORY_BLOCKS];
+static unsigned int blocksCount = 0;
+static unsigned long extendedMemorySize = 0;
+static struct BlockMoveTable blockMoveTable;
+static unsigned char bounceWord[2]; /* used to copy the last odd byte */
+
+static unsigned int getExtendedMemoryKilobytes(void) {
+    unsigned int kilobytes;
+    _AH = 0x88;
+    CALL_SYSTEM_BIOS();
+    kilobytes = _AX;
+    if(_FLAGS & 1) {
+        return 0;
+    }
+    return kilobytes;
+}
+
+static void setSegmentDescriptor(struct SegmentDescriptor *descriptor, unsigned long address) {
+    descriptor->limit = 0xffff;
+    descriptor->baseLow = (unsigned int)(address & 0xffffL);
+    descriptor->baseMiddle = (unsigned char)(address >> 16);
+    descriptor->access = 0x93; /* present, data, read/write */
+    descriptor->reserved[0] = 0;
+    descriptor->reserved[1] = 0;
+}
+
+static int blockMove(unsigned long destination, unsigned long source, unsigned int words) {
+    struct BlockMoveTable far *table = (struct BlockMoveTable far *)&blockMoveTable;
+    unsigned char status;
+
+    memset(table, NULL, sizeof(struct BlockMoveTable));
+    setSegmentDescriptor(&blockMoveTable.source, source);
+    setSegmentDescriptor(&blockMoveTable.destination, destination);
+
+    asm {
+        push es
+        push si
+    }
+    _ES = FP_SEG(table);
+    _SI = FP_OFF(table);
+    _CX = words;
+    _AH = 0x87;
+    CALL_SYSTEM_BIOS();
+    status = _AH;
+    asm {
+        pop si
+        pop es
+    }
+
+    /* some BIOSes leave A20 disabled after the move */
+    if(isHighMemoryAvailable()) {
+        (void)enableA20();
+    }
+
+    return status == 0 ? SUCCESS : FAILURE;
+}
+
+int copyExtendedMemory(unsigned long destination, unsigned long source, unsigned long size) {
+    /* linear to linear copy, works for conventional memory too */
+    unsigned long chunk;
+    unsigned long bounce;
+    unsigned char lastByte;
+
+    while(size > 1) {
+        chunk = size > EXTENDED_MEMORY_MAX_MOVE ? EXTENDED_MEMORY_MAX_MOVE : (size & ~1UL);
+        if(blockMove(destination, source, (unsigned int)(chunk >> 1)) != SUCCESS) {
+            logError(LOG_MEM, ("copyExtendedMemory: block move failed\n"));
+            return FAILURE;
+        }
+        destination += chunk;
+        source += chunk;
+        size -= chunk;
+    }
+
+    if(size) {
+        /* block move copies words, so merge the last byte with the word
+           at destination */
+        bounce = convertFarPointerToLinearAddress((void far *)bounceWord);
+        if(blockMove(bounce, source, 1) != SUCCESS) {
+            return FAILURE;
+        }
+        lastByte = bounceWord[0];
+        if(blockMove(bounce, destination, 1) != SUCCESS) {
+            return FAILURE;
+        }
+        bounceWord[0] = lastByte;
+        if(blockMove(destination, bounce, 1) != SUCCESS) {
+            return FAILURE;
+        }
+    }
+    return SUCCESS;
+}
+
+int copyToExtendedMemory(unsigned long destination, void far *source, unsigned long size) {
+    return copyExtendedMemory(destination, convertFarPointerToLinearAddress(source), size);
+}
+
+int copyFromExtendedMemory(void far *destination, unsigned long source, unsigned long size) {
+    return copyExtendedMemory(convertFarPointerToLinearAddress(destination), source, size);
+}
+
+static void insertBlock(unsigned int index, unsigned long address, unsigned long size) {
+    unsigned int nextIndex;
+    for(nextIndex = blocksCount; nextIndex > index; nextIndex--) {
+        blocks[nextIndex] = blocks[nextIndex - 1];
+    }
+    blocks[index].address = address;
+    blocks[index].size = size;
+    blocks[index].isAvailable = 1;
+    blocksCount++;
+}
+
+static void removeBlock(unsigned int index) {
+    for(; index + 1 < blocksCount; index++) {
+        blocks[index] = blocks[index + 1];
+    }
+    blocksCount--;
+}
+
+unsigned long extendedMemoryAllocate(unsigned long size) {
+    /* first fit, returns linear address or 0 */
+    unsigned int index;
+
+    size = (size + 0xfL) & ~0xfL;
+    for(index = 0; index < blocksCount; index++) {
+        if(!blocks[index].isAvailable || blocks[index].size < size) {
+            continue;
+        }
+        /* when the table is full, the whole block is handed out */
+        if(blocks[index].size > size && blocksCount < EXTENDED_MEMORY_BLOCKS) {
+            insertBlock(index + 1, blocks[index].address + size, blocks[index].size - size);
+            blocks[index].size = size;
+        }
+        blocks[index].isAvailable = 0;
+
+        logTrace(LOG_MEM, ("extendedMemoryAllocate: %d KB @ %d KB\n",
+                           (unsigned int)(size >> 10), (unsigned int)(blocks[index].address >> 10)));
+        return blocks[index].address;
+    }
+    return 0;
+}
+
+void extendedMemoryFree(unsigned long address) {
+    unsigned int index;
+
+    for(index = 0; index < blocksCount; index++) {
+        if(blocks[index].address == address && !blocks[index].isAvailable) {
+            break;
+        }
+    }
+    if(index == blocksCount) {
+        logWarning(LOG_MEM, ("extendedMemoryFree: unknown block\n"));
+        return;
+    }
+
+    blocks[index].isAvailable = 1;
+    /* merge with the neighbours */
+    if(index + 1 < blocksCount && blocks[index + 1].isAvailable) {
+        blocks[index].size += blocks[index + 1].size;
+        removeBlock(index + 1);
+    }
+    if(index > 0 && blocks[index - 1].isAvailable) {
+        blocks[index - 1].size += blocks[index].size;
+        removeBlock(index);
+    }
+}
+
+unsigned long getExtendedMemorySize(void) {
+    return extendedMemorySize;
+}
+
+void dumpExtendedMemory(enum PRINT_STREAM stream) {
+    unsigned int index;
+    printFormat(stream, "extended memory: %d KB @ %d KB, %d blocks\n",
+                (unsigned int)(extendedMemorySize >> 10),
+                (unsigned int)(EXTENDED_MEMORY_START >> 10), blocksCount);
+    for(index = 0; index < blocksCount; index++) {
+        printFormat(stream, "\t%d KB @ %d KB %s\n",
+                    (unsigned int)(blocks[index].size >> 10),
+                    (unsigned int)(blocks[index].address >> 10),
+                    blocks[index].isAvailable ? "free" : "used");
+    }
+}
+
+void initializeExtendedMemory(void) {
+    unsigned long extendedMemoryEnd;
+
+    extendedMemoryEnd = 0x100000UL + ((unsigned long)getExtendedMemoryKilobytes() << 10);
+    blocksCount = 0;
+    extendedMemorySize = 0;
+    if(extendedMemoryEnd > EXTENDED_MEMORY_START) {
+        extendedMemorySize = extendedMemoryEnd - EXTENDED_MEMORY_START;
+        insertBlock(0, EXTENDED_MEMORY_START, extendedMemorySize);
+    }
+
+    #if LOG_LEVEL >= LOG_INFO
+    if(isLogEnabled(LOG_INFO, LOG_MEM)) {
+        dumpExtendedMemory(LOGGER);
+    }
+    #endif
+}
\ No newline at end of file
@@ -26,12 +26,12 @@
 #include <kernel/fat12.h>
 #include <kernel/disk.h> /* DiskOperationLBA */
 #include <kernel/memory.h> /* kmalloc */
+#include <kernel/hma.h> /* kmallocHigh */
 #include <conio.h> /* printFormat, printCharacter */
 #include <string.h> /* movedata, FP_SEG, FP_OFF, convertCharacterToLowerCase */
 
-#ifdef FAT12_DEBUG
-    #include <kernel/debug.h>
-#endif
+#include <kernel/log.h> /* logError, logInfo, logTrace, isLogEnabled */
+#include <kernel/panic.h> /* kernelPanic */
 
 static unsigned char far *fatTable = NULL;
 static unsigned char far *rootEntriesTable = NULL;
@@ -51,13 +51,20 @@ unsigned char far *getRootEntriesTable(void) {
 static void readBootSectorInformation(void) {
     unsigned char sectorsToRead = 1;
     unsigned int startLogicalBlockAddressing = 0;
-    unsigned int oem;
 
-    bootSector = (struct BootSector far *)kmalloc(SECTOR_SIZE);
-    memset(bootSector, NULL, SECTOR_SIZE);
-    (void)DiskOperationLBA(READ, sectorsToRead, startLogicalBlockAddressing, drive, bootSector);
+    /* read through the sector buffer, the table may live in the HMA */
+    bootSector = (struct BootSector far *)kmallocHigh(SECTOR_SIZE);
+    if(!bootSector) {
+        kernelPanic("FAT12: no memory for the boot sector");
+    }
+    memset(buffer, NULL, SECTOR_SIZE);
+    (void)DiskOperationLBA(READ, sectorsToRead, startLogicalBlockAddressing, drive, buffer);
+    movedata(FP_SEG(buffer), FP_OFF(buffer), FP_SEG(bootSector), FP_OFF(bootSector), SECTOR_SIZE);
+
+    #if LOG_LEVEL >= LOG_INFO
+    if(isLogEnabled(LOG_INFO, LOG_FAT)) {
+        unsigned int oem;
 
-    #ifdef FAT12_DEBUG
         printFormat(LOGGER, "Read boot sector information\n");
         printFormat(LOGGER, "\tOemName: ");
         for(oem=0; oem<8; oem++) {
@@ -74,9 +81,48 @@ static void readBootSectorInformation(void) {
         printFormat(LOGGER, "\tSectorsPerTrack: %d\n", bootSector->biosParameterBlock.sectorsPerTrack);
         printFormat(LOGGER, "\tHeadsPerCylinder: %d\n", bootSector->biosParameterBlock.headsPerCylinder);
         printFormat(LOGGER, "\tHiddenSectors: %d\n", bootSector->biosParameterBlock.hiddenSectors);
+    }
     #endif
 }
 
+static void far *readTable(unsigned char sectorsToRead, unsigned int startLogicalBlockAddressing, size_t size) {
+    /* kernel tables are kept in the HMA when available. The BIOS can't
+       DMA above 1MB, so the sectors are read into a temporary conventional
+       buffer that is released after the copy */
+    void far *table;
+    void far *temporaryBuffer;
+    unsigned int sector;
+    unsigned int copySize;
+
+    table = kmallocHigh(size);
+    if(!table) {
+        logError(LOG_FAT, ("readTable: no memory for %x bytes\n", size));
+        return NULL;
+    }
+    if(FP_SEG(table) != HMA_SEGMENT) {
+        memset(table, NULL, size);
+        (void)DiskOperationLBA(READ, sectorsToRead, startLogicalBlockAddressing, drive, table);
+        return table;
+    }
+
+    temporaryBuffer = kmalloc(size);
+    if(!temporaryBuffer) {
+        /* no room for the whole table, copy it a sector at a time */
+        memset(table, NULL, size);
+        for(sector = 0; sector < sectorsToRead && sector * SECTOR_SIZE < size; sector++) {
+            copySize = size - sector * SECTOR_SIZE < SECTOR_SIZE ? size - sector * SECTOR_SIZE : SECTOR_SIZE;
+            (void)DiskOperationLBA(READ, 1, startLogicalBlockAddressing + sector, drive, buffer);
+            movedata(FP_SEG(buffer), FP_OFF(buffer), FP_SEG(table), FP_OFF(table) + sector * SECTOR_SIZE, copySize);
+        }
+        return table;
+    }
+    memset(temporaryBuffer, NULL, size);
+    (void)DiskOperationLBA(READ, sectorsToRead, startLogicalBlockAddressing, drive, temporaryBuffer);
+    movedata(FP_SEG(temporaryBuffer), FP_OFF(temporaryBuffer), FP_SEG(table), FP_OFF(table), size);
+    kfree(temporaryBuffer);
+    return table;
+}
+
 static void readFATtable(void) {
     size_t fatSize;
     unsigned char sectorsToRead;
@@ -87,19 +133,13 @@ static void readFATtable(void) {
     sectorsToRead = (unsigned char)bootSector->biosParameterBlock.sectorsPerFAT;
     startLogicalBlockAddressing = bootSector->biosParameterBlock.reservedSectors;
 
-    fatTable = (unsigned char far *)kmalloc(fatSize);
-    memset(fatTable, NULL, fatSize);
-    
-    (void)DiskOperationLBA(READ, sectorsToRead, startLogicalBlockAddressing,
-                           drive, fatTable);
-
-    #ifdef FAT12_DEBUG
-        printFormat(LOGGER, "Read FAT table\n");
-        printFormat(LOGGER, "\tFat size: %d\n", fatSize);
-        printFormat(LOGGER, "\tSectors to read: %d\n", sectorsToRead);
-        printFormat(LOGGER, "\tstarting lba: %d\n", startLogicalBlockAddressing);
-        printFormat(LOGGER, "\tcopy at address %x:%x\n", FP_SEG(fatTable), FP_OFF(fatTable));
-    #endif
+    fatTable = (unsigned char far *)readTable(sectorsToRead, startLogicalBlockAddressing, fatSize);
+
+    logTrace(LOG_FAT, ("Read FAT table\n"));
+    logTrace(LOG_FAT, ("\tFat size: %d\n", fatSize));
+    logTrace(LOG_FAT, ("\tSectors to read: %d\n", sectorsToRead));
+    logTrace(LOG_FAT, ("\tstarting lba: %d\n", startLogicalBlockAddressing));
+    logTrace(LOG_FAT, ("\tcopy at address %x:%x\n", FP_SEG(fatTable), FP_OFF(fatTable)));
 }
 
 static void readRootEntriesTable(void) {
@@ -113,18 +153,12 @@ static void readRootEntriesTable(void) {
                                   bootSector->biosParameterBlock.sectorsPerFAT +
                                   bootSector->biosParameterBlock.reservedSectors;
 
-    rootEntriesTable = (unsigned char far *)kmalloc(entriesSize);
-    memset(rootEntriesTable, NULL, entriesSize);
-
-    (void)DiskOperationLBA(READ, sectorsToRead, startLogicalBlockAddressing,
-                           drive, rootEntriesTable);
-    #ifdef FAT12_DEBUG
-        printFormat(LOGGER, "Read root entries table\n");
-        printFormat(LOGGER, "\tEntries size in bytes: %d\n", entriesSize);
-        printFormat(LOGGER, "\tSectors to read: %d\n", sectorsToRead);
-        printFormat(LOGGER, "\tstarting lba: %d\n", startLogicalBlockAddressing);
-        printFormat(LOGGER, "\tcopy at address %x:%x\n", FP_SEG(entriesSize), FP_OFF(entriesSize));
-    #endif
+    rootEntriesTable = (unsigned char far *)readTable(sectorsToRead, startLogicalBlockAddressing, entriesSize);
+    logTrace(LOG_FAT, ("Read root entries table\n"));
+    logTrace(LOG_FAT, ("\tEntries size in bytes: %d\n", entriesSize));
+    logTrace(LOG_FAT, ("\tSectors to read: %d\n", sectorsToRead));
+    logTrace(LOG_FAT, ("\tstarting lba: %d\n", startLogicalBlockAddressing));
+    logTrace(LOG_FAT, ("\tcopy at address %x:%x\n", FP_SEG(rootEntriesTable), FP_OFF(rootEntriesTable)));
 }
 
 static void initializeFATDataAddress(void) {
@@ -157,9 +191,7 @@ struct FileInformation far *getFileInformation(unsigned char far *rootTable, uns
     /* Directories (such as the root directory) exist like files on the disk */
     struct FileInformation far *currentFile;
     unsigned int currentOffset = 0;
-    #ifdef FAT12_DEBUG
-        printFormat(LOGGER, "getFileInformation: [%s],", fileName);
-    #endif
+    logTrace(LOG_FAT, ("getFileInformation: [%s],", fileName));
 
     while(currentOffset < bootSector->biosParameterBlock.rootEntries &&
           rootTable[currentOffset] != NULL) {
@@ -174,16 +206,12 @@ struct FileInformation far *getFileInformation(unsigned char far *rootTable, uns
 
         /* @note: taking advantage of buffer overflow, we can check the extentions also */
         if(isFileNamesEqual(currentFile->name, fileName)) {
-            #ifdef FAT12_DEBUG
-                printFormat(LOGGER, "found at lba=%d\n", currentFile->firstLogicalCluster);
-            #endif
+            logTrace(LOG_FAT, ("found at lba=%d\n", currentFile->firstLogicalCluster));
             return currentFile;
         }
     }
 
-    #ifdef FAT12_DEBUG
-        printFormat(LOGGER, "not found\n");
-    #endif
+    logTrace(LOG_FAT, ("not found\n"));
     return NULL; /* file not found */
 }
 
@@ -192,23 +220,25 @@ unsigned int getFileStartLogicalBlockAddressingInData(unsigned int cluster) {
     unsigned int startLogicalBlockAddressing;
     startLogicalBlockAddressing = dataStartAddress + ((cluster - 2) *
                 bootSector->biosParameterBlock.sectorsPerCluster);
-    #ifdef FAT12_DEBUG
-        printFormat(LOGGER, "\t\tgetFileStartLogicalBlockAddressingInData ");
-        printFormat(LOGGER, "@ data area lba=%d\n", startLogicalBlockAddressing);
-    #endif
+    logTrace(LOG_FAT, ("\t\tgetFileStartLogicalBlockAddressingInData "));
+    logTrace(LOG_FAT, ("@ data area lba=%d\n", startLogicalBlockAddressing));
     return startLogicalBlockAddressing;
 }
 
 void initializeFAT12(unsigned char bootDrive) {
-    #ifdef FAT12_DEBUG
-        printFormat(LOGGER, "Initialize FAT12 system\n");
-    #endif
+    logInfo(LOG_FAT, ("Initialize FAT12 system\n"));
 
     drive = bootDrive;
     buffer = (unsigned char far *)kmalloc(SECTOR_SIZE);
+    if(!buffer) {
+        kernelPanic("FAT12: no memory for the sector buffer");
+    }
 
     readBootSectorInformation();
     readFATtable();
     readRootEntriesTable();
+    if(!fatTable || !rootEntriesTable) {
+        kernelPanic("FAT12: no memory for the FAT and root entries tables");
+    }
     initializeFATDataAddress();
 }
\ No newline at end of file
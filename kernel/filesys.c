@@ -25,29 +25,27 @@
 
 #include <kernel/filesys.h> /*  */
 #include <string.h> /* NULL */
-#include <kernel/memory.h> /* kmalloc */
-#ifdef FILESYS_DEBUG
-    #include <kernel/debug.h>
-#endif
+#include <kernel/memory.h> /* kmalloc, convertLinearAddressToFarPointer */
+#include <kernel/process.h> /* getCurrentProcess */
+#include <kernel/log.h> /* logWarning, logInfo, logTrace, isLogEnabled */
 
 static unsigned char drive;
 static unsigned char far *buffer = NULL; /* multi purpose buffer with sector size */
+static unsigned int bufferLba = 0; /* sector held by buffer for readFile, 0 is none (boot sector) */
 static unsigned char far *fatTable = NULL;
 static unsigned char far *rootEntriesTable = NULL;
+static struct File far *openFiles = NULL;
 
 void loadFile(struct File far *file, unsigned char far *outBuffer) {
     /* if buffer is NULL, the output will be on stdout*/
     unsigned int index = 0;
     struct ClusterChain far *chunk = file->clusterChain;
 
-    #ifdef FILESYS_DEBUG
-    printFormat(LOGGER, "\tloadFile: ");
-    #endif
+    logTrace(LOG_FS, ("\tloadFile: "));
     while(chunk != NULL) {
-        #ifdef FILESYS_DEBUG
-        printFormat(LOGGER, "lba=%d @ size=%d,", chunk->cluster, chunk->size);
-        #endif
+        logTrace(LOG_FS, ("lba=%d @ size=%d,", chunk->cluster, chunk->size));
         (void)DiskOperationLBA(READ, 1 /* one sector */, chunk->cluster, drive, buffer);
+        bufferLba = 0;
         
         if(outBuffer) {
             movedata(FP_SEG(buffer), FP_OFF(buffer),
@@ -59,37 +57,145 @@ void loadFile(struct File far *file, unsigned char far *outBuffer) {
             for(index=0; index<chunk->size; index++) {
                 printCharacter(STDOUT, buffer[(unsigned)index]);
             }
+            flushConsole();
+        }
+
+        chunk = chunk->next;
+    }
+    logTrace(LOG_FS, ("\n"));
+}
+
+static unsigned int isCrossingDmaBoundary(unsigned long address, unsigned long size) {
+    /* floppy DMA can't cross a 64K physical page */
+    return (address & 0xffffL) + size > 0x10000L;
+}
+
+/* read length bytes starting at offset into outBuffer
+   @return bytes read, short at the end of file
+   @note whole sectors go straight to outBuffer, consecutive sectors on the
+         same track with one BIOS call. Partial sectors and sectors crossing
+         a DMA page are read through the sector buffer
+*/
+unsigned long readFile(struct File far *file, unsigned long offset, void far *outBuffer, unsigned long length) {
+    struct ClusterChain far *chunk = file->clusterChain;
+    unsigned long address = convertFarPointerToLinearAddress(outBuffer);
+    unsigned long bytesRead = 0;
+    unsigned int sectorOffset;
+    unsigned int count;
+    unsigned int sectors;
+    unsigned int maxSectors;
+    unsigned long sector;
+    struct ClusterChain far *lastChunk;
+
+    if(offset >= file->size) {
+        return 0;
+    }
+    if(length > file->size - offset) {
+        length = file->size - offset;
+    }
+
+    /* sequential reads continue from the chain node of the last read */
+    sector = offset / SECTOR_SIZE;
+    if(file->cursorChunk && sector >= file->cursorSector) {
+        chunk = file->cursorChunk;
+        sector -= file->cursorSector;
+    }
+    for(; sector && chunk != NULL; sector--) {
+        chunk = chunk->next;
+    }
+    if(chunk != NULL) {
+        file->cursorChunk = chunk;
+        file->cursorSector = offset / SECTOR_SIZE;
+    }
+
+    logTrace(LOG_FS, ("	readFile: offset=%x length=%x\n", (unsigned int)offset, (unsigned int)length));
+
+    sectorOffset = (unsigned int)(offset % SECTOR_SIZE);
+    while(length && chunk != NULL) {
+        count = SECTOR_SIZE - sectorOffset;
+        if(count > length) {
+            count = (unsigned int)length;
+        }
+
+        if(count == SECTOR_SIZE && chunk->cluster != bufferLba &&
+           !isCrossingDmaBoundary(address, SECTOR_SIZE)) {
+            sectors = 1;
+            lastChunk = chunk;
+            maxSectors = getSectorsToTrackEnd(chunk->cluster);
+            while(sectors < maxSectors && lastChunk->next != NULL &&
+                  lastChunk->next->cluster == lastChunk->cluster + 1 &&
+                  length >= (unsigned long)(sectors + 1) * SECTOR_SIZE &&
+                  !isCrossingDmaBoundary(address, (unsigned long)(sectors + 1) * SECTOR_SIZE)) {
+                lastChunk = lastChunk->next;
+                sectors++;
+            }
+            (void)DiskOperationLBA(READ, (unsigned char)sectors, chunk->cluster, drive,
+                                   convertLinearAddressToFarPointer(address));
+            count = sectors * SECTOR_SIZE;
+            chunk = lastChunk;
+        }
+        else {
+            if(bufferLba != chunk->cluster) {
+                (void)DiskOperationLBA(READ, 1 /* one sector */, chunk->cluster, drive, buffer);
+                bufferLba = chunk->cluster;
+            }
+            movedata(FP_SEG(buffer), FP_OFF(buffer) + sectorOffset,
+                     (unsigned int)(address >> 4), (unsigned int)(address & 0xf),
+                     count);
         }
 
+        address += count;
+        bytesRead += count;
+        length -= count;
+        sectorOffset = 0;
         chunk = chunk->next;
     }
-    #ifdef FILESYS_DEBUG
-    printFormat(LOGGER, "\n");
-    #endif
+    return bytesRead;
 }
 
 void fclose(struct File far *file) {
     struct ClusterChain far *currentCluster;
     struct ClusterChain far *nextCluster;
+    struct File far *previousFile;
 
-    #ifdef FILESYS_DEBUG
-    printFormat(LOGGER, "fclose: delete clusters=");
-    #endif
+    logTrace(LOG_FS, ("fclose: delete clusters="));
+
+    /* unlink from the open files */
+    if(openFiles == file) {
+        openFiles = file->next;
+    }
+    else {
+        for(previousFile = openFiles; previousFile != NULL; previousFile = previousFile->next) {
+            if(previousFile->next == file) {
+                previousFile->next = file->next;
+                break;
+            }
+        }
+    }
 
     /* delete cluster chain linked list */
     currentCluster = file->clusterChain;
     while(currentCluster != NULL) {
-        #ifdef FILESYS_DEBUG
-        printFormat(LOGGER, "%d,", currentCluster->cluster);
-        #endif
+        logTrace(LOG_FS, ("%d,", currentCluster->cluster));
         nextCluster = currentCluster->next;
         kfree(currentCluster);
         currentCluster = nextCluster;
     }
     kfree(file);
-    #ifdef FILESYS_DEBUG
-    printFormat(LOGGER, "Done");
-    #endif
+    logTrace(LOG_FS, ("Done"));
+}
+
+/* files left open by a process are closed when it exits */
+void closeProcessFiles(unsigned int processId) {
+    struct File far *file = openFiles;
+    struct File far *nextFile;
+    while(file != NULL) {
+        nextFile = file->next;
+        if(file->processId == processId) {
+            fclose(file);
+        }
+        file = nextFile;
+    }
 }
 
 static struct ClusterChain far *buildFileClusterChain(struct FileInformation far *fileInformation) {
@@ -99,9 +205,7 @@ static struct ClusterChain far *buildFileClusterChain(struct FileInformation far
     struct ClusterChain far *clusterChainHead = NULL;
     struct ClusterChain far *clusterChainLast = NULL;
     struct ClusterChain far *clusterChainNew = NULL;
-    #ifdef FILESYS_DEBUG
-    printFormat(LOGGER, "\tbuildFileClusterChain:\n");
-    #endif
+    logTrace(LOG_FS, ("\tbuildFileClusterChain:\n"));
     while(1) {
         /* Construct the linked list */
         clusterChainNew = (struct ClusterChain far *)kmalloc(sizeof(struct ClusterChain));
@@ -111,9 +215,10 @@ static struct ClusterChain far *buildFileClusterChain(struct FileInformation far
 
         if(clusterChainHead == NULL) {
             clusterChainHead = clusterChainNew;
-            clusterChainLast = clusterChainHead;
         }
-        clusterChainLast->next = clusterChainNew;
+        else {
+            clusterChainLast->next = clusterChainNew;
+        }
         clusterChainLast = clusterChainNew;
 
         /* Read FAT table*/
@@ -150,13 +255,12 @@ static struct FileInformation far *readDirectoryContent(unsigned int cluster, ch
     unsigned int fat_offset;
     struct FileInformation far *fileInformation;
 
-    #ifdef FILESYS_DEBUG
-    printFormat(LOGGER, "\t readDirectoryContent\n");
-    #endif
+    logTrace(LOG_FS, ("\t readDirectoryContent\n"));
     while(1) {
         start = getFileStartLogicalBlockAddressingInData(cluster);
         /* read data */
         (void)DiskOperationLBA(READ, 1 /* one sector */, start, drive, buffer);
+        bufferLba = 0;
 
         // is the first buffer contains the entry that hold the file information\n
         fileInformation = getFileInformation(buffer, (unsigned char far*)MK_FP(FP_SEG(fileNameNext), FP_OFF(fileNameNext)));
@@ -201,9 +305,7 @@ struct FileInformation far *openPath(char *path) {
     int root = 1;
 
     if(path[0] != '/') {
-        #ifdef FILESYS_DEBUG
-        printFormat(LOGGER, "\tCan't handle relative path for now\n");
-        #endif
+        logWarning(LOG_FS, ("\tCan't handle relative path for now\n"));
         return NULL;
     }
 
@@ -224,34 +326,24 @@ struct FileInformation far *openPath(char *path) {
         }
         fileNameNext[fileNameIndex]='\0';
 
-        #ifdef FILESYS_DEBUG
-        printFormat(LOGGER, "\t fileName:[%s]\n", fileName);
-        printFormat(LOGGER, "\t fileNameNext:[%s]\n",fileNameNext);
-        #endif
+        logTrace(LOG_FS, ("\t fileName:[%s]\n", fileName));
+        logTrace(LOG_FS, ("\t fileNameNext:[%s]\n",fileNameNext));
 
         if(root) { /* start from root, only one time */
-            #ifdef FILESYS_DEBUG
-            printFormat(LOGGER, "\tStarting from root\n");
-            #endif
+            logTrace(LOG_FS, ("\tStarting from root\n"));
             fileInformation = getFileInformation(rootEntriesTable, (unsigned char far*)MK_FP(FP_SEG(fileName), FP_OFF(fileName)));
             if(!fileInformation) {
-                #ifdef FILESYS_DEBUG
-                printFormat(LOGGER, "\t[%s] is not found\n", fileName);
-                #endif
+                logTrace(LOG_FS, ("\t[%s] is not found\n", fileName));
                 return NULL;
             }
             root = 0;
         }
 
         if(fileNameNext[0]=='\0') {
-            #ifdef FILESYS_DEBUG
-            printFormat(LOGGER, "\tReach end of path:[%s]\n", fileName);
-            #endif
+            logTrace(LOG_FS, ("\tReach end of path:[%s]\n", fileName));
             fileInformation = readDirectoryContent(fileInformation->firstLogicalCluster, fileName);
             if(!fileInformation) {
-                #ifdef FILESYS_DEBUG
-                printFormat(LOGGER, "\t[%s] is not found\n", fileName);
-                #endif
+                logTrace(LOG_FS, ("\t[%s] is not found\n", fileName));
                 return NULL;
             }
         }
@@ -259,15 +351,11 @@ struct FileInformation far *openPath(char *path) {
             if(fileInformation->attributes == DIRECTORY) {
                 fileInformation = readDirectoryContent(fileInformation->firstLogicalCluster, fileNameNext);
                 if(!fileInformation) {
-                    #ifdef FILESYS_DEBUG
-                    printFormat(LOGGER, "\t[%s] is not found\n", fileNameNext);
-                    #endif
+                    logTrace(LOG_FS, ("\t[%s] is not found\n", fileNameNext));
                     return NULL;
                 }
                 if(fileInformation->attributes == DIRECTORY) {
-                    #ifdef FILESYS_DEBUG
-                    printFormat(LOGGER, "\tDig into folder path\n");
-                    #endif
+                    logTrace(LOG_FS, ("\tDig into folder path\n"));
                     continue;
                 }
             }
@@ -289,10 +377,9 @@ struct File far *fopen(char *path) {
     static unsigned int fileId = 0;
     struct FileInformation far *fileInformation = NULL;
     struct File far *file = NULL;
+    struct Process far *process = getCurrentProcess();
 
-    #ifdef FILESYS_DEBUG
-    printFormat(LOGGER, "fopen:\n");
-    #endif
+    logTrace(LOG_FS, ("fopen:\n"));
 
     fileInformation = openPath(path);
     if(!fileInformation) {
@@ -303,9 +390,11 @@ struct File far *fopen(char *path) {
     memset(file, NULL, sizeof(struct File));
 
     file->fileId = fileId++;
-    file->processId = 0; //TODO
+    file->processId = process ? process->processId : 0; /* 0 is the kernel */
     file->size = fileInformation->size;
     file->clusterChain = buildFileClusterChain(fileInformation);
+    file->next = openFiles;
+    openFiles = file;
     movedata(FP_SEG(fileInformation->name), FP_OFF(fileInformation->name),
              FP_SEG(file->name), FP_OFF(file->name), FILE_NAME_SIZE);
     movedata(FP_SEG(fileInformation->extension), FP_OFF(fileInformation->extension),
@@ -326,9 +415,7 @@ struct File far *fopen(char *path) {
 
 
 void initializeFileSystem(unsigned char bootDrive) {
-    #ifdef FILESYS_DEBUG
-    printFormat(LOGGER, "initializeFileSystem:\n");
-    #endif
+    logInfo(LOG_FS, ("initializeFileSystem:\n"));
     drive = bootDrive;
     buffer = (unsigned char far *)kmalloc(SECTOR_SIZE);
     fatTable = getFatTable();
@@ -350,9 +437,7 @@ static void showDirectory(unsigned char far *rootTable) {
     unsigned int filesCount = 0;
     unsigned int directoriesCount = 0;
 
-    #ifdef FILESYS_DEBUG
-        printFormat(LOGGER, "showDirectory\n");
-    #endif
+    logTrace(LOG_FS, ("showDirectory\n"));
 
     while(currentOffset < bootSector->biosParameterBlock.rootEntries &&
           rootTable[currentOffset] != NULL) {
@@ -365,9 +450,11 @@ static void showDirectory(unsigned char far *rootTable) {
             continue;
         }
 
-        #ifdef FILESYS_DEBUG
+        #if LOG_LEVEL >= LOG_TRACE
+        if(isLogEnabled(LOG_TRACE, LOG_FS)) {
             printCharacter(LOGGER, '\t');
             printFileName(LOGGER, file->name, FILE_NAME_SIZE);
+        }
         #endif
 
         printFileName(STDOUT, file->name, FILE_NAME_SIZE);
@@ -377,19 +464,19 @@ static void showDirectory(unsigned char far *rootTable) {
         } else {
             printCharacter(STDOUT, '.');
             printFileName(STDOUT, file->extension, FILE_EXTENSION_SIZE);
-            printFormat(STDOUT, " <file> %d", file->size);
+            printFormat(STDOUT, " <file> %lu", file->size);
             filesCount += 1;
-            #ifdef FILESYS_DEBUG
+            #if LOG_LEVEL >= LOG_TRACE
+            if(isLogEnabled(LOG_TRACE, LOG_FS)) {
                 printCharacter(LOGGER, '.');
                 printFileName(LOGGER, file->extension, FILE_EXTENSION_SIZE);
-                printFormat(LOGGER, ", file size:%d", file->size);
+                printFormat(LOGGER, ", file size:%lu", file->size);
+            }
             #endif
         }
-        #ifdef FILESYS_DEBUG
-            printFormat(LOGGER, ", at root entry offset:%d, file lba:%d\n",
-                        currentOffset - sizeof(struct FileInformation),
-                        file->firstLogicalCluster);
-        #endif
+        logTrace(LOG_FS, (", at root entry offset:%d, file lba:%d\n",
+                          currentOffset - sizeof(struct FileInformation),
+                          file->firstLogicalCluster));
 
         printFormat(STDOUT, " %d:%d:%d", file->lastWriteTime.hour,
                                          file->lastWriteTime.minutes,
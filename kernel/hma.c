@@ -0,0 +1,192 @@
+/************************************************************************
+* Copyright (C) 2020 by Ahmad Dajani                                    *
+*                                                                       *
+* This file is part of NOS.                                             *
+*                                                                       *
+* NOS is free software: you can redistribute it and/or modify it        *
+* under the terms of the GNU Lesser General Public License as published *
+* by the Free Software Foundation, either version 3 of the License, or  *
+* (at your option) any later version.                                   *
+*                                                                       *
+* NOS is distributed in the hope that it will be useful,                *
+* but WITHOUT ANY WARRANTY* without even the implied warranty of        *
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+* GNU Lesser General Public License for more details.                   *
+*                                                                       *
+* You should have received a copy of the GNU Lesser General Public      *
+* License along with NOS.  If not, see <http://www.gnu.org/licenses/>.  *
+************************************************************************/
+
+/*@file hma.c
+* @author Ahmad Dajani <eng.adajani@gmail.com>
+* @date 19 Oct 2026
+* @brief High memory area (FFFF:0010) source file
+* @note With A20 enabled, FFFF:0010-FFFF:FFFF addresses the first 64KB
+*       above 1MB. Kernel tables are kept there to leave the conventional
+*       heap to process images. The BIOS can't DMA into it, so disk reads
+*       must go through a conventional buffer.
+*/
+
+#include <kernel/hma.h>
+#include <kernel/memory.h> /* kmalloc, kfree */
+#include <bios.h> /* CALL_SYSTEM_BIOS */
+#include <conio.h> /* printFormat, inPortByte, outPortByte */
+#include <string.h> /* MK_FP, FP_SEG, FP_OFF */
+#include <kernel/log.h> /* logWarning, logInfo, logTrace */
+
+static int isHighMemoryInitialized = 0;
+
+int isA20Enabled(void) {
+    /* with A20 disabled FFFF:0510 wraps around to 0000:0500 */
+    unsigned char far *low = (unsigned char far *)MK_FP(0x0000, 0x0500);
+    unsigned char far *high = (unsigned char far *)MK_FP(0xffff, 0x0510);
+    unsigned char savedLow = *low;
+    unsigned char savedHigh = *high;
+    int isEnabled;
+
+    *low = 0x00;
+    *high = 0xff;
+    isEnabled = (*low != 0xff);
+    *high = savedHigh;
+    *low = savedLow;
+    return isEnabled;
+}
+
+static void waitKeyboardController(void) {
+    /* wait for empty input buffer */
+    while(inPortByte(0x64) & 2);
+}
+
+int enableA20(void) {
+    unsigned char value;
+
+    if(isA20Enabled()) {
+        return 1;
+    }
+
+    /* 1. BIOS */
+    _AX = 0x2401;
+    CALL_SYSTEM_BIOS();
+    if(isA20Enabled()) {
+        return 1;
+    }
+
+    /* 2. keyboard controller output port */
+    waitKeyboardController();
+    outPortByte(0x64, 0xd1);
+    waitKeyboardController();
+    outPortByte(0x60, 0xdf);
+    waitKeyboardController();
+    if(isA20Enabled()) {
+        return 1;
+    }
+
+    /* 3. fast A20 (system control port A), bit 0 resets the machine */
+    value = inPortByte(0x92);
+    outPortByte(0x92, (value | 2) & 0xfe);
+    return isA20Enabled();
+}
+
+static struct HighMemoryBlock far *getHighMemoryBlock(unsigned long offset) {
+    return (struct HighMemoryBlock far *)MK_FP(HMA_SEGMENT, (unsigned int)offset);
+}
+
+void initializeHighMemory(void) {
+    struct HighMemoryBlock far *block;
+
+    isHighMemoryInitialized = enableA20();
+    if(!isHighMemoryInitialized) {
+        logWarning(LOG_MEM, ("initializeHighMemory: A20 can't be enabled\n"));
+        return;
+    }
+
+    block = getHighMemoryBlock(HMA_START_OFFSET);
+    block->size = (unsigned int)(HMA_END_OFFSET - HMA_START_OFFSET);
+    block->isAvailable = 1;
+
+    logInfo(LOG_MEM, ("initializeHighMemory: %x bytes @ %x:%x\n",
+                      block->size, HMA_SEGMENT, (unsigned int)HMA_START_OFFSET));
+}
+
+int isHighMemoryAvailable(void) {
+    return isHighMemoryInitialized;
+}
+
+void far *hmalloc(unsigned int size) {
+    /* first fit, adjacent free blocks are merged by hfree */
+    unsigned long offset;
+    struct HighMemoryBlock far *block;
+    unsigned int remainSize;
+
+    if(!isHighMemoryInitialized || size > HMA_END_OFFSET - HMA_START_OFFSET - sizeof(struct HighMemoryBlock)) {
+        return NULL;
+    }
+    size = (size + sizeof(struct HighMemoryBlock) + 1) & ~1;
+
+    for(offset = HMA_START_OFFSET; offset < HMA_END_OFFSET; offset += block->size) {
+        block = getHighMemoryBlock(offset);
+        if(!block->isAvailable || block->size < size) {
+            continue;
+        }
+
+        remainSize = block->size - size;
+        if(remainSize >= HMA_MINIMUM_SPLIT) {
+            block->size = size;
+            getHighMemoryBlock(offset + size)->size = remainSize;
+            getHighMemoryBlock(offset + size)->isAvailable = 1;
+        }
+        block->isAvailable = 0;
+
+        logTrace(LOG_MEM, ("hmalloc: %x bytes @ %x:%x\n", block->size, HMA_SEGMENT,
+                           (unsigned int)offset + sizeof(struct HighMemoryBlock)));
+        return MK_FP(HMA_SEGMENT, (unsigned int)offset + sizeof(struct HighMemoryBlock));
+    }
+    return NULL;
+}
+
+void hfree(void far *address) {
+    unsigned long offset;
+    unsigned long nextOffset;
+    struct HighMemoryBlock far *block;
+    struct HighMemoryBlock far *nextBlock;
+
+    if(!address || FP_SEG(address) != HMA_SEGMENT) {
+        return;
+    }
+
+    offset = FP_OFF(address) - sizeof(struct HighMemoryBlock);
+    block = getHighMemoryBlock(offset);
+    block->isAvailable = 1;
+
+    /* merge the following free blocks */
+    nextOffset = offset + block->size;
+    while(nextOffset < HMA_END_OFFSET) {
+        nextBlock = getHighMemoryBlock(nextOffset);
+        if(!nextBlock->isAvailable) {
+            break;
+        }
+        block->size += nextBlock->size;
+        nextOffset += nextBlock->size;
+    }
+}
+
+void far *kmallocHigh(unsigned long size) {
+    /* HMA first, conventional heap as fallback */
+    void far *address = NULL;
+    if(size < HMA_END_OFFSET) {
+        address = hmalloc((unsigned int)size);
+    }
+    if(!address) {
+        address = kmalloc(size);
+    }
+    return address;
+}
+
+void kfreeHigh(void far *address) {
+    if(address && FP_SEG(address) == HMA_SEGMENT) {
+        hfree(address);
+    }
+    else {
+        kfree(address);
+    }
+}
\ No newline at end of file
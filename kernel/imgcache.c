@@ -0,0 +1,274 @@
+/************************************************************************
+* Copyright (C) 2020 by Ahmad Dajani                                    *
+*                                                                       *
+* This file is part of NOS.                                             *
+*                                                                       *
+* NOS is free software: you can redistribute it and/or modify it        *
+* under the terms of the GNU Lesser General Public License as published *
+* by the Free Software Foundation, either version 3 of the License, or  *
+* (at your option) any later version.                                   *
+*                                                                       *
+* NOS is distributed in the hope that it will be useful,                *
+* but WITHOUT ANY WARRANTY* without even the implied warranty of        *
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+* GNU Lesser General Public License for more details.                   *
+*                                                                       *
+* You should have received a copy of the GNU Lesser General Public      *
+* License along with NOS.  If not, see <http://www.gnu.org/licenses/>.  *
+************************************************************************/
+
+/*@file imgcache.c
+* @author Ahmad Dajani <eng.adajani@gmail.com>
+* @date 19 Oct 2026
+* @brief Loaded executable image cache source file
+* @note Images are kept unrelocated, in extended memory when available,
+*       otherwise in the kernel heap. The least recently used image is
+*       evicted when the budget is exceeded.
+*/
+
+#include <kernel/imgcache.h>
+#include <kernel/extmem.h> /* extendedMemoryAllocate, copyExtendedMemory */
+#include <kernel/memory.h> /* kmalloc, kfree, convertLinearAddressToFarPointer */
+#include <kernel/disk.h> /* SUCCESS, FAILURE */
+#include <string.h> /* NULL, movedata */
+#include <kernel/log.h> /* logInfo, logTrace */
+
+static struct CachedImage images[IMAGE_CACHE_ENTRIES];
+static unsigned long budget = 0;
+static unsigned long bytesCached = 0;
+static unsigned int useClock = 0;
+static unsigned int isExtendedAvailable = 0;
+
+static int copyLinear(unsigned long destination, unsigned long source, unsigned long size, unsigned int isExtended) {
+    /* extended memory goes through the BIOS block move, conventional
+       memory is copied directly with normalized pointers */
+    unsigned int chunk;
+    void far *from;
+    void far *to;
+
+    if(isExtended) {
+        return copyExtendedMemory(destination, source, size);
+    }
+    while(size) {
+        chunk = size > 0xfff0UL ? 0xfff0 : (unsigned int)size;
+        from = convertLinearAddressToFarPointer(source);
+        to = convertLinearAddressToFarPointer(destination);
+        movedata(FP_SEG(from), FP_OFF(from), FP_SEG(to), FP_OFF(to), chunk);
+        destination += chunk;
+        source += chunk;
+        size -= chunk;
+    }
+    return SUCCESS;
+}
+
+int isImageCacheKeyEqual(struct ImageCacheKey *left, struct ImageCacheKey *right) {
+    register unsigned int index;
+    for(index = 0; index < IMAGE_CACHE_PATH_SIZE && left->path[index] == right->path[index]; index++) {
+        if(left->path[index] == '\0') {
+            break;
+        }
+    }
+    return index < IMAGE_CACHE_PATH_SIZE && left->path[index] == right->path[index] &&
+           left->size == right->size &&
+           left->lastWriteTime == right->lastWriteTime &&
+           left->lastWriteDate == right->lastWriteDate &&
+           left->firstLogicalCluster == right->firstLogicalCluster;
+}
+
+static int isPathEqual(struct ImageCacheKey *left, struct ImageCacheKey *right) {
+    register unsigned int index;
+    for(index = 0; index < IMAGE_CACHE_PATH_SIZE; index++) {
+        if(left->path[index] != right->path[index]) {
+            return 0;
+        }
+        if(left->path[index] == '\0') {
+            break;
+        }
+    }
+    return 1;
+}
+
+static void releaseStorage(struct CachedImage *cachedImage) {
+    if(cachedImage->isExtended) {
+        extendedMemoryFree(cachedImage->address);
+    }
+    else {
+        kfree(convertLinearAddressToFarPointer(cachedImage->address));
+    }
+}
+
+void dropCachedImage(struct CachedImage *cachedImage) {
+    logTrace(LOG_EXEC, ("imgcache: drop %s\n", cachedImage->key.path));
+    releaseStorage(cachedImage);
+    bytesCached -= cachedImage->storageSize;
+    cachedImage->isUsed = 0;
+}
+
+static struct CachedImage *getLeastRecentlyUsed(void) {
+    struct CachedImage *oldest = NULL;
+    register unsigned int index;
+    for(index = 0; index < IMAGE_CACHE_ENTRIES; index++) {
+        if(images[index].isUsed &&
+           (oldest == NULL || (unsigned int)(useClock - images[index].lastUsed) >
+                              (unsigned int)(useClock - oldest->lastUsed))) {
+            oldest = &images[index];
+        }
+    }
+    return oldest;
+}
+
+static struct CachedImage *getFreeEntry(void) {
+    register unsigned int index;
+    for(index = 0; index < IMAGE_CACHE_ENTRIES; index++) {
+        if(!images[index].isUsed) {
+            return &images[index];
+        }
+    }
+    return NULL;
+}
+
+static int evictLeastRecentlyUsed(void) {
+    struct CachedImage *oldest = getLeastRecentlyUsed();
+    if(!oldest) {
+        return 0;
+    }
+    dropCachedImage(oldest);
+    return 1;
+}
+
+static unsigned long allocateStorage(unsigned long size) {
+    void far *address;
+    if(isExtendedAvailable) {
+        return extendedMemoryAllocate(size);
+    }
+    address = kmalloc(size);
+    return address ? convertFarPointerToLinearAddress(address) : 0;
+}
+
+void setImageCacheBudget(unsigned long newBudget) {
+    budget = newBudget;
+    while(bytesCached > budget && evictLeastRecentlyUsed());
+}
+
+void initializeImageCache(void) {
+    memset((void far *)images, NULL, sizeof(images));
+    bytesCached = 0;
+    isExtendedAvailable = getExtendedMemorySize() != 0;
+    setImageCacheBudget(isExtendedAvailable ? IMAGE_CACHE_EXTENDED_BUDGET : IMAGE_CACHE_CONVENTIONAL_BUDGET);
+    logInfo(LOG_EXEC, ("imgcache: budget %x paragraphs in %s memory\n",
+                       (unsigned int)(budget >> 4), isExtendedAvailable ? "extended" : "conventional"));
+}
+
+int makeImageCacheKey(struct ImageCacheKey *key, char *path, struct FileInformation far *fileInformation) {
+    /* @return 0 if the path doesn't fit the key */
+    register unsigned int index;
+    for(index = 0; path[index] != '\0'; index++) {
+        if(index == IMAGE_CACHE_PATH_SIZE - 1) {
+            return 0;
+        }
+        key->path[index] = path[index];
+    }
+    key->path[index] = '\0';
+    key->size = fileInformation->size;
+    key->lastWriteTime = *(unsigned int far *)&fileInformation->lastWriteTime;
+    key->lastWriteDate = *(unsigned int far *)&fileInformation->lastWriteDate;
+    key->firstLogicalCluster = fileInformation->firstLogicalCluster;
+    return 1;
+}
+
+struct CachedImage *findCachedImage(struct ImageCacheKey *key) {
+    register unsigned int index;
+    for(index = 0; index < IMAGE_CACHE_ENTRIES; index++) {
+        if(!images[index].isUsed || !isPathEqual(&images[index].key, key)) {
+            continue;
+        }
+        if(!isImageCacheKeyEqual(&images[index].key, key)) {
+            /* the file was changed on disk */
+            dropCachedImage(&images[index]);
+            return NULL;
+        }
+        images[index].lastUsed = ++useClock;
+        logTrace(LOG_EXEC, ("imgcache: hit %s\n", key->path));
+        return &images[index];
+    }
+    return NULL;
+}
+
+struct CachedImage *cacheImage(struct ImageCacheKey *key, struct ExecutableFile *header,
+                               void far *image, unsigned long loadModuleSize) {
+    /* must be called before the image is relocated, the relocation table
+       is added later by writeCachedRelocations */
+    struct CachedImage *cachedImage;
+    unsigned long storageSize;
+    unsigned long address;
+
+    storageSize = (loadModuleSize + (unsigned long)header->relocationItems * sizeof(struct RelocationTable) + 1) & ~1UL;
+    if(storageSize > budget) {
+        return NULL;
+    }
+
+    while(bytesCached + storageSize > budget || getFreeEntry() == NULL) {
+        if(!evictLeastRecentlyUsed()) {
+            return NULL;
+        }
+    }
+    while((address = allocateStorage(storageSize)) == 0) {
+        if(!evictLeastRecentlyUsed()) {
+            return NULL;
+        }
+    }
+
+    cachedImage = getFreeEntry();
+    cachedImage->key = *key;
+    cachedImage->header = *header;
+    cachedImage->address = address;
+    cachedImage->storageSize = storageSize;
+    cachedImage->loadModuleSize = loadModuleSize;
+    cachedImage->isExtended = isExtendedAvailable;
+    cachedImage->lastUsed = ++useClock;
+    cachedImage->isUsed = 1;
+    bytesCached += storageSize;
+
+    if(copyLinear(address, convertFarPointerToLinearAddress(image), loadModuleSize,
+                  cachedImage->isExtended) != SUCCESS) {
+        dropCachedImage(cachedImage);
+        return NULL;
+    }
+
+    logTrace(LOG_EXEC, ("imgcache: store %s, %x paragraphs\n",
+                        key->path, (unsigned int)(storageSize >> 4)));
+    return cachedImage;
+}
+
+int loadCachedImage(struct CachedImage *cachedImage, void far *image) {
+    return copyLinear(convertFarPointerToLinearAddress(image), cachedImage->address,
+                      cachedImage->loadModuleSize, cachedImage->isExtended);
+}
+
+int readCachedRelocations(struct CachedImage *cachedImage, unsigned int firstItem,
+                          struct RelocationTable far *relocations, unsigned int count) {
+    return copyLinear(convertFarPointerToLinearAddress(relocations),
+                      cachedImage->address + cachedImage->loadModuleSize +
+                      (unsigned long)firstItem * sizeof(struct RelocationTable),
+                      (unsigned long)count * sizeof(struct RelocationTable), cachedImage->isExtended);
+}
+
+int writeCachedRelocations(struct CachedImage *cachedImage, unsigned int firstItem,
+                           struct RelocationTable far *relocations, unsigned int count) {
+    return copyLinear(cachedImage->address + cachedImage->loadModuleSize +
+                      (unsigned long)firstItem * sizeof(struct RelocationTable),
+                      convertFarPointerToLinearAddress(relocations),
+                      (unsigned long)count * sizeof(struct RelocationTable), cachedImage->isExtended);
+}
+
+void dumpImageCache(enum PRINT_STREAM stream) {
+    register unsigned int index;
+    printFormat(stream, "Image cache: %x of %x paragraphs\n",
+                (unsigned int)(bytesCached >> 4), (unsigned int)(budget >> 4));
+    for(index = 0; index < IMAGE_CACHE_ENTRIES; index++) {
+        if(images[index].isUsed) {
+            printFormat(stream, "\t%s: %x paragraphs, last used %d\n", images[index].key.path,
+                        (unsigned int)(images[index].storageSize >> 4), images[index].lastUsed);
+        }
+    }
+}
\ No newline at end of file
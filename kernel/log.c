@@ -0,0 +1,59 @@
+/************************************************************************
+* Copyright (C) 2020 by Ahmad Dajani                                    *
+*                                                                       *
+* This file is part of NOS.                                             *
+*                                                                       *
+* NOS is free software: you can redistribute it and/or modify it        *
+* under the terms of the GNU Lesser General Public License as published *
+* by the Free Software Foundation, either version 3 of the License, or  *
+* (at your option) any later version.                                   *
+*                                                                       *
+* NOS is distributed in the hope that it will be useful,                *
+* but WITHOUT ANY WARRANTY* without even the implied warranty of        *
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+* GNU Lesser General Public License for more details.                   *
+*                                                                       *
+* You should have received a copy of the GNU Lesser General Public      *
+* License along with NOS.  If not, see <http://www.gnu.org/licenses/>.  *
+************************************************************************/
+
+/*@file log.c
+* @author Ahmad Dajani <eng.adajani@gmail.com>
+* @date 19 Oct 2026
+* @brief Kernel logging source file
+*/
+
+#include <kernel/log.h>
+#include <conio.h> /* formatString, writeStream */
+#include <stdarg.h> /* va_list, va_start, va_end */
+#include <string.h> /* MK_FP */
+
+/* every compiled level starts with all subsystems */
+unsigned char logMask[LOG_LEVELS] = {LOG_ALL, LOG_ALL, LOG_ALL, LOG_ALL};
+
+void logPrint(char *format, ...) {
+    /* formatted on the caller stack, SS may differ from DS */
+    char message[FORMAT_BUFFER_SIZE];
+    char far *messagePointer = (char far *)MK_FP(_SS, (unsigned int)message);
+    unsigned int length;
+    va_list arguments;
+
+    va_start(arguments, format);
+    length = formatString(messagePointer, FORMAT_BUFFER_SIZE, format, arguments);
+    va_end(arguments);
+    if(length >= FORMAT_BUFFER_SIZE) {
+        length = FORMAT_BUFFER_SIZE - 1;
+    }
+    writeStream(LOGGER, messagePointer, length);
+}
+
+unsigned char setLogMask(unsigned int level, unsigned char subsystems) {
+    unsigned char previousMask;
+
+    if(level >= LOG_LEVELS) {
+        return 0;
+    }
+    previousMask = logMask[level];
+    logMask[level] = subsystems & LOG_ALL;
+    return previousMask;
+}
\ No newline at end of file
@@ -26,17 +26,35 @@
 
 #include <kernel/memory.h>
 #include <bios.h> /* CALL_MEMORY_BIOS */
-#include <math.h> /* abs */
 #include <conio.h> /* printFormat */
 #include <string.h> /* memset */
-#ifdef KMEM_DEBUG
-    #include <kernel/debug.h>
+#include <kernel/log.h> /* logError, logWarning, logInfo, logTrace */
+#include <kernel/debug.h> /* DebugBreak */
+#ifdef KMEM_TRACE
+    #ifndef KMEM_CALLER
+        /* return address of the current function, needs the standard stack frame (-k) */
+        #define KMEM_CALLER() (*(unsigned int *)(_BP + 2))
+    #endif
 #endif
 
 unsigned long startAddress = NULL;
 unsigned long lastValidAddress = NULL;
 unsigned long initializedAddress = NULL;
 
+/* maintained by kmalloc, kmalloc_align and kfree, @see getHeapStatistics */
+static unsigned long bytesInUse = 0;
+static unsigned long highWaterMark = 0;
+static unsigned long allocationsCount = 0;
+static unsigned long freesCount = 0;
+
+static void accountAllocation(unsigned long size) {
+    bytesInUse += size;
+    if(bytesInUse > highWaterMark) {
+        highWaterMark = bytesInUse;
+    }
+    allocationsCount++;
+}
+
 unsigned long getLastValidAddress(void) {
     CALL_MEMORY_BIOS();
     /* Operation     Notes
@@ -56,6 +74,10 @@ void far *convertLinearAddressToFarPointer(unsigned long address) {
     return (void far *)MK_FP(segment, offset);
 }
 
+unsigned long convertFarPointerToLinearAddress(void far *address) {
+    return ((unsigned long)FP_SEG(address) << 4) + FP_OFF(address);
+}
+
 void initializeMemory(unsigned int heapStart) {
     /*
     on computer restart, the memory will still have 
@@ -70,17 +92,16 @@ void initializeMemory(unsigned int heapStart) {
     startAddress = (unsigned long)(((unsigned long)_CS << 4) + heapStart);
     lastValidAddress = getLastValidAddress();
     initializedAddress = startAddress; /* used in kmalloc to track the new regions*/
+    bytesInUse = highWaterMark = allocationsCount = freesCount = 0;
 
     totalMemory = (lastValidAddress - startAddress) + 1;
 
     chunkSize = (unsigned int)(totalMemory / 0xffffL);
     remainChunkSize = (unsigned int)(totalMemory % 0xffffL);
 
-    #ifdef KMEM_DEBUG
-    printFormat(LOGGER, "initialize memory:\n");
-    printFormat(LOGGER, "\tKernel heap start @ %x:%x\n", _CS, heapStart);
-    printFormat(LOGGER, "\tprobe %x chuncks with size %x. remainChunkSize is %x\n", chunkSize, 0xffff, remainChunkSize);
-    #endif
+    logInfo(LOG_MEM, ("initialize memory:\n"));
+    logInfo(LOG_MEM, ("\tKernel heap start @ %x:%x\n", _CS, heapStart));
+    logInfo(LOG_MEM, ("\tprobe %x chuncks with size %x. remainChunkSize is %x\n", chunkSize, 0xffff, remainChunkSize));
 
     currentAddress = startAddress;
     for(nextChunk=0; nextChunk<chunkSize; nextChunk++) {
@@ -90,172 +111,331 @@ void initializeMemory(unsigned int heapStart) {
     if(remainChunkSize) {
         memset(convertLinearAddressToFarPointer(currentAddress), NULL, remainChunkSize);
     }
-    #ifdef KMEM_DEBUG
     DebugBreak();
-    #endif
 }
 
 
-/* Return an address with segment:0 which is compatible to run EXE 
-   TODO: utilized allocated aligned blocks
-*/
-void far *kmalloc_align(unsigned long size) {
-    struct MemoryControlBlock far *currentMemoryControlBlock = NULL;
-    unsigned long newAddress = 0;
-    unsigned long aligned_address = 0;
-    void far *ret = NULL;
-
-    #ifdef KMEM_DEBUG
-    printFormat(LOGGER, "kmalloc_align:");
-    #endif
+static struct MemoryControlBlock far *getMemoryControlBlock(unsigned long address) {
+    return (struct MemoryControlBlock far *)convertLinearAddressToFarPointer(address);
+}
 
-    size += sizeof(struct MemoryControlBlock);
+static void createMemoryControlBlock(unsigned long address, unsigned long size, unsigned int isAvailable) {
+    struct MemoryControlBlock far *currentMemoryControlBlock = getMemoryControlBlock(address);
+    currentMemoryControlBlock->isInitialized = 1;
+    currentMemoryControlBlock->isAvailable = isAvailable;
+    currentMemoryControlBlock->magic = KMALLOC_PRIME_MAGIC;
+    currentMemoryControlBlock->size = size;
+}
 
-    /* Try to allocate new MCB struct */
-    if(abs((long)lastValidAddress - (long)initializedAddress) < size) {
-        #ifdef KMEM_DEBUG
-        printFormat(LOGGER, "no free memory\n");
-        #endif        
-        return NULL; /* no free space */
+static unsigned long getAlignedPadding(unsigned long address) {
+    /* bytes to skip in front of an MCB at address, so its payload starts
+       at offset 0. The skipped bytes become a free block, so they must be
+       large enough to hold its own MCB */
+    unsigned long payload = address + sizeof(struct MemoryControlBlock);
+    if((payload & 0xfL) == 0) {
+        return 0;
     }
+    return ((payload + sizeof(struct MemoryControlBlock) + 0xfL) & ~0xfL) - payload;
+}
 
-    currentMemoryControlBlock = (struct MemoryControlBlock far *)initializedAddress;
-    currentMemoryControlBlock->isInitialized = 1;
-    currentMemoryControlBlock->magic = KMALLOC_PRIME_MAGIC;
+static void mergeFreeBlocks(unsigned long address) {
+    /* merge the free blocks that follow the block at address */
+    struct MemoryControlBlock far *currentMemoryControlBlock = getMemoryControlBlock(address);
+    struct MemoryControlBlock far *nextMemoryControlBlock;
+    unsigned long nextAddress = address + currentMemoryControlBlock->size;
 
-    newAddress = (long)initializedAddress + sizeof(struct MemoryControlBlock);
-    /* already aligned */
-    if(FP_OFF((void far *)newAddress) == 0) {
-        #ifdef KMEM_DEBUG
-        printFormat(LOGGER, "address is aligned\n");
-        #endif
-        currentMemoryControlBlock->isAvailable = 0;
-        currentMemoryControlBlock->size = size;
-        ret = convertLinearAddressToFarPointer(newAddress);
-        initializedAddress += size;
-        return ret;
+    while(nextAddress < initializedAddress) {
+        nextMemoryControlBlock = getMemoryControlBlock(nextAddress);
+        if(!nextMemoryControlBlock->isAvailable) {
+            break;
+        }
+        currentMemoryControlBlock->size += nextMemoryControlBlock->size;
+        nextAddress += nextMemoryControlBlock->size;
+        nextMemoryControlBlock->magic = 0;
     }
 
-    #ifdef KMEM_DEBUG
-    printFormat(LOGGER, "address is not aligned @ offset=%d\n", FP_OFF((void far *)newAddress));
-    #endif
-    /* search for alligned address */
-    aligned_address = newAddress;
-    while(aligned_address < (long)lastValidAddress && FP_OFF(aligned_address) != 0) {
-        aligned_address += 1;
+    /* the last block goes back to the untouched area */
+    if(nextAddress == initializedAddress) {
+        currentMemoryControlBlock->magic = 0;
+        initializedAddress = address;
     }
+}
 
-    #ifdef KMEM_DEBUG
-    printFormat(LOGGER, "Mark address @ offset=%d as free\n", FP_OFF((void far *)initializedAddress));
-    #endif
+static void splitBlock(unsigned long address, unsigned long size) {
+    struct MemoryControlBlock far *currentMemoryControlBlock = getMemoryControlBlock(address);
+    unsigned long remainSize = currentMemoryControlBlock->size - size;
 
-    /*  mark old MCB as free */
-    currentMemoryControlBlock->isAvailable = 1;
-    currentMemoryControlBlock->size = aligned_address - newAddress;
-    #ifdef KMEM_DEBUG
-    printFormat(LOGGER, "adjust address to offset=%d\n", FP_OFF((void far *)newAddress));
-    #endif
+    if(remainSize < KMALLOC_MINIMUM_SPLIT) {
+        return; /* keep the tail inside the block */
+    }
+    currentMemoryControlBlock->size = size;
+    createMemoryControlBlock(address + size, remainSize, 1);
+}
 
-    /* is there memory after alignment ? */
-    if(abs((long)lastValidAddress - ((long)initializedAddress+(long)currentMemoryControlBlock->size)) < size) {
-        #ifdef KMEM_DEBUG
-        printFormat(LOGGER, "no free memoery after alignment\n");
-        #endif
-        return NULL; /* no free space */
+static unsigned long allocateFromFreeBlocks(unsigned long size, unsigned int isAligned) {
+    /* first fit, adjacent free blocks are merged during the walk */
+    unsigned long currentAddress = startAddress;
+    unsigned long padding;
+    struct MemoryControlBlock far *currentMemoryControlBlock;
+
+    while(currentAddress < initializedAddress) {
+        currentMemoryControlBlock = getMemoryControlBlock(currentAddress);
+        if(currentMemoryControlBlock->isAvailable) {
+            mergeFreeBlocks(currentAddress);
+            if(currentAddress >= initializedAddress) {
+                break; /* merged into the untouched area */
+            }
+
+            padding = isAligned ? getAlignedPadding(currentAddress) : 0;
+            if(currentMemoryControlBlock->size >= padding + size) {
+                if(padding) {
+                    createMemoryControlBlock(currentAddress + padding,
+                                             currentMemoryControlBlock->size - padding, 1);
+                    currentMemoryControlBlock->size = padding;
+                    currentAddress += padding;
+                    currentMemoryControlBlock = getMemoryControlBlock(currentAddress);
+                }
+                splitBlock(currentAddress, size);
+                currentMemoryControlBlock->isAvailable = 0;
+
+                logTrace(LOG_MEM, ("kmalloc: use struct\n"));
+                return currentAddress;
+            }
+        }
+        currentAddress += currentMemoryControlBlock->size;
     }
+    return NULL;
+}
 
-    initializedAddress += currentMemoryControlBlock->size;
+static unsigned long allocateFromUntouchedArea(unsigned long size, unsigned int isAligned) {
+    unsigned long padding = isAligned ? getAlignedPadding(initializedAddress) : 0;
+    unsigned long newAddress;
 
-    /* new block */
-    currentMemoryControlBlock = (struct MemoryControlBlock far *)initializedAddress;
-    currentMemoryControlBlock->isInitialized = 1;
-    currentMemoryControlBlock->isAvailable = 0;
-    currentMemoryControlBlock->size = size;
-    currentMemoryControlBlock->magic = KMALLOC_PRIME_MAGIC;
+    if(initializedAddress + padding + size - 1 > lastValidAddress) {
+        logWarning(LOG_MEM, ("kmalloc: no free memory\n"));
+        return NULL; /* no free space */
+    }
 
-    ret = convertLinearAddressToFarPointer(initializedAddress + sizeof(struct MemoryControlBlock));
-    
-    #ifdef KMEM_DEBUG
-    printFormat(LOGGER, "new aligned address at offset=%d\n", FP_OFF((void far *)ret));
-    #endif
-    
+    if(padding) {
+        createMemoryControlBlock(initializedAddress, padding, 1);
+        initializedAddress += padding;
+    }
+
+    newAddress = initializedAddress;
+    createMemoryControlBlock(newAddress, size, 0);
     initializedAddress += size;
-    return ret;
+
+    logTrace(LOG_MEM, ("kmalloc: create new struct\n"));
+    return newAddress;
 }
 
-/*
-    - all available memory can be allocated
-    - blocks larger than 64k can be allocated
-*/
-void far *kmalloc(unsigned long size) {
-    unsigned long currentAddress = NULL;
-    struct MemoryControlBlock far *currentMemoryControlBlock = NULL;
-    void far *newAddress = NULL;
+static void far *allocateBlock(unsigned long size, unsigned int isAligned) {
+    unsigned long newAddress;
 
     size += sizeof(struct MemoryControlBlock);
 
-    /* Try to allocate new MCB struct */
-    if(abs((long)lastValidAddress - (long)initializedAddress) >= size) {
-        currentMemoryControlBlock = (struct MemoryControlBlock far *)initializedAddress;
-        currentMemoryControlBlock->isInitialized = 1;
-        currentMemoryControlBlock->isAvailable = 0;
-        currentMemoryControlBlock->size = size;
-        currentMemoryControlBlock->magic = KMALLOC_PRIME_MAGIC;
+    newAddress = allocateFromFreeBlocks(size, isAligned);
+    if(newAddress == NULL) {
+        newAddress = allocateFromUntouchedArea(size, isAligned);
+        if(newAddress == NULL) {
+            /* Sorry: no more memory for you :( */
+            return NULL;
+        }
+    }
 
-        #ifdef KMEM_DEBUG
-        printFormat(LOGGER, "kmalloc: create new struct\n");
-        #endif
+    accountAllocation(getMemoryControlBlock(newAddress)->size);
+    return convertLinearAddressToFarPointer(newAddress + sizeof(struct MemoryControlBlock));
+}
 
-        newAddress = convertLinearAddressToFarPointer(initializedAddress + sizeof(struct MemoryControlBlock));
+static unsigned long allocateAtAddress(unsigned long address, unsigned long size) {
+    /* the MCB goes exactly at address, the range must be free */
+    unsigned long currentAddress = startAddress;
+    unsigned long leading;
+    struct MemoryControlBlock far *currentMemoryControlBlock;
+
+    while(currentAddress < initializedAddress) {
+        currentMemoryControlBlock = getMemoryControlBlock(currentAddress);
+        if(currentMemoryControlBlock->isAvailable) {
+            mergeFreeBlocks(currentAddress);
+            if(currentAddress >= initializedAddress) {
+                break; /* merged into the untouched area */
+            }
+        }
+        if(address < currentAddress + currentMemoryControlBlock->size) {
+            leading = address - currentAddress;
+            if(!currentMemoryControlBlock->isAvailable ||
+               address + size > currentAddress + currentMemoryControlBlock->size ||
+               (leading && leading < sizeof(struct MemoryControlBlock))) {
+                return NULL;
+            }
+            if(leading) {
+                createMemoryControlBlock(address, currentMemoryControlBlock->size - leading, 1);
+                currentMemoryControlBlock->size = leading;
+                currentMemoryControlBlock = getMemoryControlBlock(address);
+            }
+            splitBlock(address, size);
+            currentMemoryControlBlock->isAvailable = 0;
+            return address;
+        }
+        currentAddress += currentMemoryControlBlock->size;
+    }
 
-        initializedAddress += size;
-        return newAddress;
+    leading = address - initializedAddress;
+    if(address < initializedAddress || address + size - 1 > lastValidAddress ||
+       (leading && leading < sizeof(struct MemoryControlBlock))) {
+        return NULL;
+    }
+    if(leading) {
+        createMemoryControlBlock(initializedAddress, leading, 1);
     }
+    createMemoryControlBlock(address, size, 0);
+    initializedAddress = address + size;
+    return address;
+}
 
-    /* If MCB already created then try to utilize existing struct */
-    currentAddress = startAddress;
-    while(currentAddress != lastValidAddress) {
-        currentMemoryControlBlock = (struct MemoryControlBlock far *)currentAddress;
+#ifdef KMEM_TRACE
+/* one line per call, replayed by tools/kmembench */
+static void traceAllocation(unsigned long size, unsigned int isAligned, void far *address, unsigned int caller) {
+    unsigned long linearAddress = address ? convertFarPointerToLinearAddress(address) : 0;
+    printFormat(LOGGER, "@kmalloc size=%x:%x aligned=%d address=%x:%x caller=%x\n",
+                (unsigned int)(size >> 16), (unsigned int)size, isAligned,
+                (unsigned int)(linearAddress >> 16), (unsigned int)linearAddress, caller);
+}
 
-        if(currentMemoryControlBlock->isAvailable &&
-           currentMemoryControlBlock->size >= size) {
-            currentMemoryControlBlock->isAvailable = 0;
-            currentMemoryControlBlock->size = size;
+static void traceFree(void far *address, unsigned int caller) {
+    unsigned long linearAddress = convertFarPointerToLinearAddress(address);
+    printFormat(LOGGER, "@kfree address=%x:%x caller=%x\n",
+                (unsigned int)(linearAddress >> 16), (unsigned int)linearAddress, caller);
+}
+#endif
 
-            #ifdef KMEM_DEBUG
-            printFormat(LOGGER, "kmalloc: use struct\n");
-            #endif
+/* Return an address with segment:0 which is compatible to run EXE */
+void far *kmalloc_align(unsigned long size) {
+    void far *address = allocateBlock(size, 1);
+    #ifdef KMEM_TRACE
+    traceAllocation(size, 1, address, KMEM_CALLER());
+    #endif
+    return address;
+}
 
-            currentAddress += sizeof(struct MemoryControlBlock);
-            return convertLinearAddressToFarPointer(currentAddress);
-        }
-        currentAddress += currentMemoryControlBlock->size;
-    }
+/*
+    - all available memory can be allocated
+    - blocks larger than 64k can be allocated
+    - free blocks are reused before touching new memory, so the heap
+      doesn't grow when the same sizes are allocated and freed
+*/
+void far *kmalloc(unsigned long size) {
+    void far *address = allocateBlock(size, 0);
+    #ifdef KMEM_TRACE
+    traceAllocation(size, 0, address, KMEM_CALLER());
+    #endif
+    return address;
+}
 
-    /* TODO: can't find continuous empty slot, so try to merge slots into bigger one */
+/* Allocate the block again at an address returned by kmalloc before, for
+   memory swapped out with its far pointers still in use, @see swap.c */
+void far *kmalloc_at(void far *address, unsigned long size) {
+    unsigned long newAddress = convertFarPointerToLinearAddress(address) - sizeof(struct MemoryControlBlock);
 
-    /* Sorry: no more memory for you :( */
-    return NULL;
+    size += sizeof(struct MemoryControlBlock);
+    if(newAddress < startAddress) {
+        return NULL;
+    }
+    newAddress = allocateAtAddress(newAddress, size);
+    if(newAddress == NULL) {
+        return NULL;
+    }
+    accountAllocation(getMemoryControlBlock(newAddress)->size);
+    #ifdef KMEM_TRACE
+    traceAllocation(size - sizeof(struct MemoryControlBlock), 0, address, KMEM_CALLER());
+    #endif
+    return address;
+}
+
+/* @return usable bytes of a kmalloc block, at least the requested size */
+unsigned long getAllocationSize(void far *address) {
+    unsigned long linearAddress = convertFarPointerToLinearAddress(address) - sizeof(struct MemoryControlBlock);
+    return getMemoryControlBlock(linearAddress)->size - sizeof(struct MemoryControlBlock);
 }
 
 void kfree(void far *address) {
     struct MemoryControlBlock far *currentMemoryControlBlock = NULL;
-    unsigned long linearAddress = (unsigned long)address;
+    unsigned long linearAddress;
 
     if(!address) {
         return;
     }
 
+    #ifdef KMEM_TRACE
+    traceFree(address, KMEM_CALLER());
+    #endif
+
+    linearAddress = convertFarPointerToLinearAddress(address);
     linearAddress -= sizeof(struct MemoryControlBlock);
 
-    currentMemoryControlBlock = (struct MemoryControlBlock far *)linearAddress;
+    currentMemoryControlBlock = getMemoryControlBlock(linearAddress);
 
-    if(currentMemoryControlBlock->magic != KMALLOC_PRIME_MAGIC) {
-        #ifdef KMEM_DEBUG
-        printFormat(LOGGER, "kfree: invalid MCB header\n");
-        #endif
+    if(currentMemoryControlBlock->magic != KMALLOC_PRIME_MAGIC ||
+       currentMemoryControlBlock->isAvailable) {
+        logError(LOG_MEM, ("kfree: invalid MCB header\n"));
         return;
     }
 
     currentMemoryControlBlock->isAvailable = 1;
+    bytesInUse -= currentMemoryControlBlock->size;
+    freesCount++;
+    mergeFreeBlocks(linearAddress);
+}
+
+void getHeapStatistics(struct HeapStatistics far *statistics) {
+    /* walk the MCB chain from the heap start up to the last created block */
+    unsigned long currentAddress = startAddress;
+    struct MemoryControlBlock far *currentMemoryControlBlock;
+
+    memset(statistics, NULL, sizeof(struct HeapStatistics));
+
+    while(currentAddress < initializedAddress) {
+        currentMemoryControlBlock = getMemoryControlBlock(currentAddress);
+        if(currentMemoryControlBlock->magic != KMALLOC_PRIME_MAGIC ||
+           currentMemoryControlBlock->size == 0) {
+            statistics->isCorrupted = 1;
+            break;
+        }
+
+        statistics->blocks++;
+        if(currentMemoryControlBlock->isAvailable) {
+            statistics->freeBlocks++;
+            statistics->freeBytes += currentMemoryControlBlock->size;
+            if(currentMemoryControlBlock->size > statistics->largestFreeBlock) {
+                statistics->largestFreeBlock = currentMemoryControlBlock->size;
+            }
+        }
+        currentAddress += currentMemoryControlBlock->size;
+    }
+
+    statistics->heapSize = (lastValidAddress - startAddress) + 1;
+    statistics->untouchedBytes = lastValidAddress - initializedAddress;
+    statistics->bytesInUse = bytesInUse;
+    statistics->highWaterMark = highWaterMark;
+    statistics->allocations = allocationsCount;
+    statistics->frees = freesCount;
+}
+
+void dumpHeapStatistics(enum PRINT_STREAM stream) {
+    static struct HeapStatistics statistics;
+    getHeapStatistics(&statistics);
+
+    printFormat(stream, "kernel heap:\n");
+    printFormat(stream, "\theap size: 0x%lx bytes\n", statistics.heapSize);
+    printFormat(stream, "\tin use: 0x%lx bytes, high water mark: 0x%lx bytes\n",
+                statistics.bytesInUse, statistics.highWaterMark);
+    printFormat(stream, "\tMCBs: %d, free MCBs: %d, free: 0x%lx bytes\n",
+                statistics.blocks, statistics.freeBlocks, statistics.freeBytes);
+    printFormat(stream, "\tlargest free block: 0x%lx bytes\n", statistics.largestFreeBlock);
+    printFormat(stream, "\tuntouched (lastValidAddress - initializedAddress): 0x%lx bytes\n",
+                statistics.untouchedBytes);
+    printFormat(stream, "\tkmalloc calls: %lu, kfree calls: %lu\n", statistics.allocations, statistics.frees);
+    if(statistics.isCorrupted) {
+        printFormat(stream, "\tMCB chain is corrupted\n");
+    }
 }
\ No newline at end of file
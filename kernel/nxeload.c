@@ -0,0 +1,191 @@
+/************************************************************************
+* Copyright (C) 2020 by Ahmad Dajani                                    *
+*                                                                       *
+* This file is part of NOS.                                             *
+*                                                                       *
+* NOS is free software: you can redistribute it and/or modify it        *
+* under the terms of the GNU Lesser General Public License as published *
+* by the Free Software Foundation, either version 3 of the License, or  *
+* (at your option) any later version.                                   *
+*                                                                       *
+* NOS is distributed in the hope that it will be useful,                *
+* but WITHOUT ANY WARRANTY* without even the implied warranty of        *
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+* GNU Lesser General Public License for more details.                   *
+*                                                                       *
+* You should have received a copy of the GNU Lesser General Public      *
+* License along with NOS.  If not, see <http://www.gnu.org/licenses/>.  *
+************************************************************************/
+
+/*@file nxeload.c
+* @author Ahmad Dajani <eng.adajani@gmail.com>
+* @date 19 Oct 2026
+* @brief NXE fixups and packed load modules source file
+* @note Kept apart from exec.c with no other kernel dependency than
+*       readFile, so tools\nxetest builds it on the host.
+*/
+
+#include <kernel/nxeload.h>
+#include <conio.h> /* printFormat */
+#include <string.h> /* MK_FP, FP_SEG, FP_OFF */
+#include <kernel/log.h> /* logTrace */
+
+static unsigned char sectorBuffer[SECTOR_SIZE];
+
+/* NXE fixups and packed load modules are read one sector at a time */
+struct StreamReader {
+    struct File far *file;
+    unsigned long offset; /* next file offset to read */
+    unsigned long remainBytes; /* not read yet from the file */
+    unsigned int index;
+    unsigned int count;
+    unsigned int isFailed;
+};
+
+#define READ_STREAM_BYTE(reader) \
+    ((reader)->index < (reader)->count ? sectorBuffer[(reader)->index++] : readStreamByte(reader))
+
+static unsigned char readStreamByte(struct StreamReader *reader) {
+    if(reader->index == reader->count) {
+        reader->count = reader->remainBytes > SECTOR_SIZE ? SECTOR_SIZE : (unsigned int)reader->remainBytes;
+        if(reader->count == 0 ||
+           readFile(reader->file, reader->offset, (void far *)sectorBuffer, reader->count) != reader->count) {
+            reader->isFailed = 1;
+            reader->count = 0;
+            return 0;
+        }
+        reader->offset += reader->count;
+        reader->remainBytes -= reader->count;
+        reader->index = 0;
+    }
+    return sectorBuffer[reader->index++];
+}
+
+static unsigned int readStreamWord(struct StreamReader *reader) {
+    unsigned int value = readStreamByte(reader);
+    return value | ((unsigned int)readStreamByte(reader) << 8);
+}
+
+static void openStreamReader(struct StreamReader *reader, struct File far *file,
+                             unsigned long offset, unsigned long size) {
+    reader->file = file;
+    reader->offset = offset;
+    reader->remainBytes = size;
+    reader->index = reader->count = 0;
+    reader->isFailed = 0;
+}
+
+int unpackImage(struct File far *file, unsigned long offset, unsigned long packedSize,
+                unsigned char far *image, unsigned long loadModuleSize) {
+    /* LZSS, @see include\kernel\nxe.h
+       the output offset is kept above the largest distance, so the match
+       source never needs a segment borrow */
+    struct StreamReader reader;
+    unsigned int segment = FP_SEG(image);
+    unsigned int output = FP_OFF(image);
+    unsigned int source;
+    unsigned int flags = 0;
+    unsigned int flagBits = 0;
+    unsigned int low;
+    unsigned int high;
+    unsigned int length;
+    unsigned int shift;
+    unsigned char far *window;
+
+    openStreamReader(&reader, file, offset, packedSize);
+    while(loadModuleSize && !reader.isFailed) {
+        if(output >= NXE_PACK_NORMALIZE_AT) {
+            shift = (output - NXE_PACK_WINDOW) >> 4;
+            segment += shift;
+            output -= shift << 4;
+        }
+        window = (unsigned char far *)MK_FP(segment, 0);
+
+        if(flagBits == 0) {
+            flags = READ_STREAM_BYTE(&reader);
+            flagBits = 8;
+        }
+        flagBits--;
+
+        if(flags & 1) {
+            window[output++] = READ_STREAM_BYTE(&reader);
+            loadModuleSize--;
+        }
+        else {
+            low = READ_STREAM_BYTE(&reader);
+            high = READ_STREAM_BYTE(&reader);
+            source = output - (low | ((high & 0xf0) << 4));
+            length = (high & 0x0f) + NXE_PACK_MIN_MATCH;
+            if(length > loadModuleSize) {
+                return 0;
+            }
+            loadModuleSize -= length;
+            while(length--) { /* byte by byte, the match may overlap the output */
+                window[output++] = window[source++];
+            }
+        }
+        flags >>= 1;
+    }
+    return !reader.isFailed;
+}
+
+int relocateNativeImage(struct File far *file, struct NativeExecutableFile *nativeHeader,
+                        unsigned int codeBase, unsigned int dataBase, int isCodeRelocated) {
+    /* one linear pass over the sorted fixups, @see include\kernel\nxe.h
+       shared code (codeParagraphs) is at codeBase and the rest of the image
+       at dataBase, the code is relocated by its first instance only */
+    struct StreamReader reader;
+    unsigned int codeParagraphs = nativeHeader->codeParagraphs;
+    unsigned int codeDelta = codeBase - nativeHeader->linkedBase;
+    unsigned int dataDelta = dataBase - codeParagraphs - nativeHeader->linkedBase;
+    unsigned int windows = nativeHeader->fixupWindows;
+    unsigned int count;
+    unsigned int offset;
+    unsigned int distance;
+    unsigned int segment;
+    unsigned long dataOffset;
+    unsigned int far *addressFixup;
+
+    if(codeParagraphs == 0 && dataDelta == 0) {
+        return 1; /* loaded where it was linked for */
+    }
+    if(nativeHeader->flags & NXE_FIXED_BASE) {
+        printFormat(STDOUT, "\tImage is linked for segment %x only\n", nativeHeader->linkedBase);
+        return 0;
+    }
+
+    openStreamReader(&reader, file, sizeof(struct NativeExecutableFile), nativeHeader->fixupBytes);
+
+    logTrace(LOG_EXEC, ("\tNXE: %d fixups in %d windows\n", nativeHeader->fixupsCount, windows));
+    while(windows-- && !reader.isFailed) {
+        segment = readStreamWord(&reader);
+        count = readStreamWord(&reader);
+        offset = 0;
+        while(count-- && !reader.isFailed) {
+            distance = READ_STREAM_BYTE(&reader);
+            if(distance == 0) {
+                distance = readStreamWord(&reader);
+            }
+            offset += distance;
+            if(codeParagraphs == 0) {
+                *(unsigned int far *)MK_FP(dataBase + segment, offset) += dataDelta;
+                continue;
+            }
+
+            if(segment + (offset >> 4) < codeParagraphs) {
+                if(!isCodeRelocated) {
+                    continue;
+                }
+                addressFixup = (unsigned int far *)MK_FP(codeBase + segment, offset);
+            }
+            else {
+                dataOffset = ((unsigned long)segment << 4) + offset - ((unsigned long)codeParagraphs << 4);
+                addressFixup = (unsigned int far *)MK_FP(dataBase + (unsigned int)(dataOffset >> 4),
+                                                         (unsigned int)dataOffset & 15);
+            }
+            /* the word refers to the code or to the data */
+            *addressFixup += *addressFixup - nativeHeader->linkedBase < codeParagraphs ? codeDelta : dataDelta;
+        }
+    }
+    return !reader.isFailed;
+}
\ No newline at end of file
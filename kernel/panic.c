@@ -0,0 +1,54 @@
+/************************************************************************
+* Copyright (C) 2020 by Ahmad Dajani                                    *
+*                                                                       *
+* This file is part of NOS.                                             *
+*                                                                       *
+* NOS is free software: you can redistribute it and/or modify it        *
+* under the terms of the GNU Lesser General Public License as published *
+* by the Free Software Foundation, either version 3 of the License, or  *
+* (at your option) any later version.                                   *
+*                                                                       *
+* NOS is distributed in the hope that it will be useful,                *
+* but WITHOUT ANY WARRANTY* without even the implied warranty of        *
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+* GNU Lesser General Public License for more details.                   *
+*                                                                       *
+* You should have received a copy of the GNU Lesser General Public      *
+* License along with NOS.  If not, see <http://www.gnu.org/licenses/>.  *
+************************************************************************/
+
+/*@file panic.c
+* @author Ahmad Dajani <eng.adajani@gmail.com>
+* @date 19 Oct 2026
+* @brief Kernel panic source file
+*/
+
+#include <kernel/panic.h>
+#include <conio.h> /* printFormat, formatString, flushLogger, flushConsole */
+#include <stdarg.h> /* va_list, va_start, va_end */
+
+static char panicMessage[FORMAT_BUFFER_SIZE];
+
+void kernelPanic(char *format, ...) {
+    va_list arguments;
+
+    asm cli
+    va_start(arguments, format);
+    (void)formatString((char far *)panicMessage, sizeof(panicMessage), format, arguments);
+    va_end(arguments);
+
+    printFormat(STDOUT, "\nKernel panic: %s\n", panicMessage);
+    /* what was queued before the panic goes out first, so the message
+       can't be dropped by a full buffer */
+    flushLogger();
+    printFormat(LOGGER, "panic: %s\n", panicMessage);
+    dumpLoggerStatistics(LOGGER);
+    flushLogger();
+
+    while(1) {
+        asm {
+            cli
+            hlt
+        }
+    }
+}
\ No newline at end of file
@@ -0,0 +1,210 @@
+/************************************************************************
+* Copyright (C) 2020 by Ahmad Dajani                                    *
+*                                                                       *
+* This file is part of NOS.                                             *
+*                                                                       *
+* NOS is free software: you can redistribute it and/or modify it        *
+* under the terms of the GNU Lesser General Public License as published *
+* by the Free Software Foundation, either version 3 of the License, or  *
+* (at your option) any later version.                                   *
+*                                                                       *
+* NOS is distributed in the hope that it will be useful,                *
+* but WITHOUT ANY WARRANTY* without even the implied warranty of        *
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+* GNU Lesser General Public License for more details.                   *
+*                                                                       *
+* You should have received a copy of the GNU Lesser General Public      *
+* License along with NOS.  If not, see <http://www.gnu.org/licenses/>.  *
+************************************************************************/
+
+/*@file pheap.c
+* @author Ahmad Dajani <eng.adajani@gmail.com>
+* @date 19 Oct 2026
+* @brief Process paragraph heap source file
+* @note API_MALLOC/API_FREE and INT 21h AH=48h/49h/4Ah use the heap of the
+*       calling process, the chunks are released with its arena.
+*/
+
+#include <kernel/pheap.h>
+#include <kernel/disk.h> /* SUCCESS, FAILURE */
+#include <conio.h> /* printFormat */
+#include <string.h> /* NULL, MK_FP, FP_SEG */
+#include <kernel/log.h> /* logTrace */
+
+#define GET_BLOCK(segment) ((struct ParagraphBlock far *)MK_FP(segment, 0))
+
+void initializeParagraphHeap(struct ParagraphHeap far *heap) {
+    heap->chunksCount = 0;
+}
+
+static void createBlock(unsigned int segment, unsigned int paragraphs, unsigned int isUsed) {
+    struct ParagraphBlock far *block = GET_BLOCK(segment);
+    block->signature = PARAGRAPH_BLOCK_SIGNATURE;
+    block->paragraphs = paragraphs;
+    block->isUsed = isUsed;
+}
+
+static void mergeFreeBlocks(unsigned int segment, unsigned int chunkEnd) {
+    /* merge the free blocks that follow the block at segment */
+    struct ParagraphBlock far *block = GET_BLOCK(segment);
+    struct ParagraphBlock far *nextBlock;
+    unsigned int nextSegment = segment + 1 + block->paragraphs;
+
+    while(nextSegment < chunkEnd) {
+        nextBlock = GET_BLOCK(nextSegment);
+        if(nextBlock->isUsed) {
+            break;
+        }
+        block->paragraphs += 1 + nextBlock->paragraphs;
+        nextSegment += 1 + nextBlock->paragraphs;
+        nextBlock->signature = 0;
+    }
+}
+
+static void splitBlock(unsigned int segment, unsigned int paragraphs) {
+    /* the tail needs a header, a one paragraph tail stays in the block */
+    struct ParagraphBlock far *block = GET_BLOCK(segment);
+    unsigned int remain = block->paragraphs - paragraphs;
+    if(remain < 2) {
+        return;
+    }
+    block->paragraphs = paragraphs;
+    createBlock(segment + 1 + paragraphs, remain - 1, 0);
+}
+
+static int findChunk(struct ParagraphHeap far *heap, unsigned int segment) {
+    /* @return chunk index of a used block header at segment, -1 otherwise */
+    register unsigned int index;
+    unsigned int current;
+    unsigned int chunkEnd;
+
+    for(index = 0; index < heap->chunksCount; index++) {
+        chunkEnd = heap->chunkSegment[index] + heap->chunkParagraphs[index];
+        if(segment < heap->chunkSegment[index] || segment >= chunkEnd) {
+            continue;
+        }
+        for(current = heap->chunkSegment[index]; current < chunkEnd; current += 1 + GET_BLOCK(current)->paragraphs) {
+            if(current == segment) {
+                return GET_BLOCK(current)->isUsed ? (int)index : -1;
+            }
+        }
+        return -1;
+    }
+    return -1;
+}
+
+static unsigned int allocateFromChunks(struct ParagraphHeap far *heap, unsigned int paragraphs,
+                                       unsigned int *largest) {
+    /* first fit, adjacent free blocks are merged during the walk */
+    register unsigned int index;
+    unsigned int current;
+    unsigned int chunkEnd;
+    struct ParagraphBlock far *block;
+
+    *largest = 0;
+    for(index = 0; index < heap->chunksCount; index++) {
+        chunkEnd = heap->chunkSegment[index] + heap->chunkParagraphs[index];
+        for(current = heap->chunkSegment[index]; current < chunkEnd; current += 1 + block->paragraphs) {
+            block = GET_BLOCK(current);
+            if(block->isUsed) {
+                continue;
+            }
+            mergeFreeBlocks(current, chunkEnd);
+            if(block->paragraphs >= paragraphs) {
+                splitBlock(current, paragraphs);
+                block->isUsed = 1;
+                return current + 1;
+            }
+            if(block->paragraphs > *largest) {
+                *largest = block->paragraphs;
+            }
+        }
+    }
+    return 0;
+}
+
+unsigned int allocateParagraphs(struct ParagraphHeap far *heap, struct Arena far *arena,
+                                unsigned int paragraphs, unsigned int *largest) {
+    /* @return block segment, 0 with the largest free block in paragraphs */
+    unsigned int segment;
+    unsigned int chunkParagraphs;
+    void far *chunk;
+
+    if(paragraphs == 0 || paragraphs > 0xfffe) {
+        *largest = 0;
+        return 0;
+    }
+    segment = allocateFromChunks(heap, paragraphs, largest);
+    if(segment || heap->chunksCount == PARAGRAPH_HEAP_CHUNKS) {
+        return segment;
+    }
+
+    chunkParagraphs = paragraphs + 1 < PARAGRAPH_HEAP_GROWTH ? PARAGRAPH_HEAP_GROWTH : paragraphs + 1;
+    chunk = arenaAllocateAligned(arena, (unsigned long)chunkParagraphs << 4);
+    if(!chunk) {
+        return 0;
+    }
+    heap->chunkSegment[heap->chunksCount] = FP_SEG(chunk);
+    heap->chunkParagraphs[heap->chunksCount] = chunkParagraphs;
+    heap->chunksCount++;
+    createBlock(FP_SEG(chunk), chunkParagraphs - 1, 0);
+
+    logTrace(LOG_MEM, ("pheap: chunk @ %x, %x paragraphs\n", FP_SEG(chunk), chunkParagraphs));
+    return allocateFromChunks(heap, paragraphs, largest);
+}
+
+int freeParagraphs(struct ParagraphHeap far *heap, unsigned int segment) {
+    int chunk = findChunk(heap, segment - 1);
+    if(chunk < 0) {
+        return FAILURE;
+    }
+    GET_BLOCK(segment - 1)->isUsed = 0;
+    mergeFreeBlocks(segment - 1, heap->chunkSegment[chunk] + heap->chunkParagraphs[chunk]);
+    return SUCCESS;
+}
+
+int resizeParagraphs(struct ParagraphHeap far *heap, unsigned int segment,
+                     unsigned int paragraphs, unsigned int *largest) {
+    /* in place, grows into the free blocks that follow
+       @return FAILURE with the largest possible size in paragraphs */
+    int chunk = findChunk(heap, segment - 1);
+    struct ParagraphBlock far *block = GET_BLOCK(segment - 1);
+    struct ParagraphBlock far *nextBlock;
+    unsigned int chunkEnd;
+    unsigned int nextSegment;
+
+    *largest = 0;
+    if(chunk < 0) {
+        return FAILURE;
+    }
+    chunkEnd = heap->chunkSegment[chunk] + heap->chunkParagraphs[chunk];
+
+    if(paragraphs > block->paragraphs) {
+        nextSegment = segment + block->paragraphs;
+        if(nextSegment < chunkEnd && !GET_BLOCK(nextSegment)->isUsed) {
+            mergeFreeBlocks(nextSegment, chunkEnd);
+            nextBlock = GET_BLOCK(nextSegment);
+            if(block->paragraphs + 1 + nextBlock->paragraphs >= paragraphs) {
+                block->paragraphs += 1 + nextBlock->paragraphs;
+                nextBlock->signature = 0;
+            }
+            else {
+                *largest = block->paragraphs + 1 + nextBlock->paragraphs;
+                return FAILURE;
+            }
+        }
+        else {
+            *largest = block->paragraphs;
+            return FAILURE;
+        }
+    }
+
+    splitBlock(segment - 1, paragraphs);
+    nextSegment = segment + block->paragraphs;
+    if(nextSegment < chunkEnd && !GET_BLOCK(nextSegment)->isUsed) {
+        mergeFreeBlocks(nextSegment, chunkEnd);
+    }
+
+    logTrace(LOG_MEM, ("pheap: resize %x to %x paragraphs\n", segment, block->paragraphs));
+    return SUCCESS;
+}
\ No newline at end of file
@@ -0,0 +1,144 @@
+/************************************************************************
+* Copyright (C) 2020 by Ahmad Dajani                                    *
+*                                                                       *
+* This file is part of NOS.                                             *
+*                                                                       *
+* NOS is free software: you can redistribute it and/or modify it        *
+* under the terms of the GNU Lesser General Public License as published *
+* by the Free Software Foundation, either version 3 of the License, or  *
+* (at your option) any later version.                                   *
+*                                                                       *
+* NOS is distributed in the hope that it will be useful,                *
+* but WITHOUT ANY WARRANTY* without even the implied warranty of        *
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+* GNU Lesser General Public License for more details.                   *
+*                                                                       *
+* You should have received a copy of the GNU Lesser General Public      *
+* License along with NOS.  If not, see <http://www.gnu.org/licenses/>.  *
+************************************************************************/
+
+/*@file process.c
+* @author Ahmad Dajani <eng.adajani@gmail.com>
+* @date 19 Oct 2026
+* @brief Kernel process source file
+*/
+
+#include <kernel/process.h>
+#include <kernel/memory.h> /* kmalloc, kfree */
+#include <kernel/filesys.h> /* closeProcessFiles */
+#include <kernel/disk.h> /* SUCCESS, FAILURE */
+#include <conio.h> /* printFormat */
+#include <string.h> /* NULL, memset, MK_FP */
+#include <kernel/log.h> /* logInfo, logTrace */
+
+#define GET_VECTOR(vector) ((unsigned long far *)MK_FP(0, (vector) << 2))
+
+static struct Process far *currentProcess = NULL;
+
+struct Process far *createProcess(void) {
+    static unsigned int processId = 1; /* 0 is the kernel */
+    struct Process far *process;
+
+    process = (struct Process far *)kmalloc(sizeof(struct Process));
+    if(!process) {
+        return NULL;
+    }
+    process->processId = processId++;
+    process->exitCode = 0;
+    process->childExitCode = 0;
+    process->sharedCode = NULL;
+    process->swapImage = NULL;
+    process->vectorsCount = 0;
+    initializeArena(&process->arena);
+    initializeParagraphHeap(&process->heap);
+    process->imageSegment = 0;
+    process->imageParagraphs = 0;
+    memset(process->files, NULL, sizeof(process->files));
+
+    logInfo(LOG_SCHED, ("createProcess: id=%d\n", process->processId));
+    return process;
+}
+
+static void writeVector(unsigned int vector, unsigned long handler) {
+    /* both words at once for the interrupt */
+    asm {
+        pushf
+        cli
+    }
+    *GET_VECTOR(vector) = handler;
+    asm popf
+}
+
+static void restoreProcessVectors(struct Process far *process) {
+    /* like DOS restores INT 22h-24h from the PSP, the handlers point into the arena */
+    register unsigned int index;
+    for(index = 0; index < process->vectorsCount; index++) {
+        writeVector(process->vectors[index].vector, process->vectors[index].handler);
+        logTrace(LOG_SCHED, ("process %d: vector %x restored\n", process->processId,
+                             process->vectors[index].vector));
+    }
+    process->vectorsCount = 0;
+}
+
+void destroyProcess(struct Process far *process) {
+    if(!process) {
+        return;
+    }
+
+    logInfo(LOG_SCHED, ("destroyProcess: id=%d, arena=%d regions\n",
+                        process->processId, process->arena.regionsCount));
+
+    restoreProcessVectors(process);
+    closeProcessFiles(process->processId);
+    releaseSharedCode(process->sharedCode);
+    if(process->swapImage) {
+        discardSwapImage(process); /* the arena regions are freed already */
+    }
+    else {
+        releaseArena(&process->arena);
+    }
+    if(currentProcess == process) {
+        currentProcess = NULL;
+    }
+    kfree(process);
+}
+
+struct Process far *getCurrentProcess(void) {
+    return currentProcess;
+}
+
+void setCurrentProcess(struct Process far *process) {
+    currentProcess = process;
+}
+
+/* back to executeBinary on the kernel stack, never returns for a process */
+void exitCurrentProcess(int exitCode) {
+    struct Process far *process = currentProcess;
+    if(!process) {
+        return; /* kernel */
+    }
+
+    logInfo(LOG_SCHED, ("exitCurrentProcess: id=%d, code=%d\n", process->processId, exitCode));
+
+    process->exitCode = exitCode;
+    restoreContext(&process->context, 1);
+}
+
+int setProcessVector(struct Process far *process, unsigned int vector, unsigned long handler) {
+    /* the handler before the first change is saved, the kernel sets its vectors for good
+       @return FAILURE when PROCESS_VECTORS are saved already */
+    register unsigned int index;
+    if(process) {
+        for(index = 0; index < process->vectorsCount && process->vectors[index].vector != vector; index++);
+        if(index == process->vectorsCount) {
+            if(index == PROCESS_VECTORS) {
+                return FAILURE;
+            }
+            process->vectors[index].vector = vector;
+            process->vectors[index].handler = *GET_VECTOR(vector);
+            process->vectorsCount++;
+        }
+    }
+    writeVector(vector, handler);
+    return SUCCESS;
+}
\ No newline at end of file
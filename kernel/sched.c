@@ -1 +1,415 @@
-/* TODO: main schedular based on PIT */
\ No newline at end of file
+/************************************************************************
+* Copyright (C) 2020 by Ahmad Dajani                                    *
+*                                                                       *
+* This file is part of NOS.                                             *
+*                                                                       *
+* NOS is free software: you can redistribute it and/or modify it        *
+* under the terms of the GNU Lesser General Public License as published *
+* by the Free Software Foundation, either version 3 of the License, or  *
+* (at your option) any later version.                                   *
+*                                                                       *
+* NOS is distributed in the hope that it will be useful,                *
+* but WITHOUT ANY WARRANTY* without even the implied warranty of        *
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+* GNU Lesser General Public License for more details.                   *
+*                                                                       *
+* You should have received a copy of the GNU Lesser General Public      *
+* License along with NOS.  If not, see <http://www.gnu.org/licenses/>.  *
+************************************************************************/
+
+/*@file sched.c
+* @author Ahmad Dajani <eng.adajani@gmail.com>
+* @date 19 Oct 2026
+* @brief Kernel cooperative task scheduler source file
+* @note Tasks give the CPU up by yield or by waiting on an event, the idle
+*       task polls the keyboard and halts when nothing is ready. Task stacks
+*       must be inside the kernel segment (SS=DS for the C code).
+*       The timer preempts tasks only while they run user code, the kernel
+*       isn't reentrant. A preempted task keeps its registers in the timer
+*       interrupt frame and resumes by returning from the interrupt.
+*       A task woken while its process is swapped out waits for the swapper
+*       task, so the ready queues only hold resident tasks and nothing is
+*       copied from the timer interrupt.
+*/
+
+#include <kernel/sched.h>
+#include <kernel/memory.h> /* kmalloc, kfree, convertFarPointerToLinearAddress */
+#include <kernel/timer.h> /* readTimerCounter, getTimerDivisor */
+#include <kernel/swap.h> /* swapInProcess, swapOutProcess */
+#include <kernel/disk.h> /* SUCCESS */
+#include <conio.h> /* printFormat, isKeyAvailable, readCharacter, drainLogger */
+#include <string.h> /* NULL, memset */
+#include <kernel/log.h> /* logTrace */
+
+static struct Task tasks[SCHEDULER_TASKS];
+static struct Task *currentTask = NULL;
+static struct Task *readyHead[TASK_PRIORITIES];
+static struct Task *readyTail[TASK_PRIORITIES];
+static struct Event keyboardEvent;
+static struct Event swapEvent; /* wakes the swapper */
+static struct Task *swapInHead = NULL; /* woken tasks of swapped out processes */
+static struct Task *swapInTail = NULL;
+
+/* context switch latency in PIT counts */
+static unsigned int switchStart;
+static unsigned int lastSwitchLatency = 0;
+static unsigned int maximumSwitchLatency = 0;
+static unsigned long totalSwitchLatency = 0;
+static unsigned long switchesCount = 0;
+
+static void enqueueReady(struct Task *task) {
+    task->state = TASK_READY;
+    task->next = NULL;
+    if(readyTail[task->priority]) {
+        readyTail[task->priority]->next = task;
+    }
+    else {
+        readyHead[task->priority] = task;
+    }
+    readyTail[task->priority] = task;
+}
+
+static enum TASK_PRIORITY getReadyPriority(void) {
+    /* TASK_PRIORITIES when nothing is ready */
+    register unsigned int priority;
+    for(priority = PRIORITY_HIGH; priority < TASK_PRIORITIES; priority++) {
+        if(readyHead[priority]) {
+            break;
+        }
+    }
+    return (enum TASK_PRIORITY)priority;
+}
+
+static struct Task *dequeueReady(void) {
+    enum TASK_PRIORITY priority = getReadyPriority();
+    struct Task *task;
+    if(priority == TASK_PRIORITIES) {
+        return NULL;
+    }
+    task = readyHead[priority];
+    readyHead[priority] = task->next;
+    if(!readyHead[priority]) {
+        readyTail[priority] = NULL;
+    }
+    task->next = NULL;
+    return task;
+}
+
+static void measureSwitchLatency(void) {
+    /* the counter goes down and reloads with the divisor */
+    unsigned int counter = readTimerCounter();
+    unsigned int latency = switchStart - counter;
+    if(counter > switchStart) {
+        latency += getTimerDivisor();
+    }
+    lastSwitchLatency = latency;
+    if(latency > maximumSwitchLatency) {
+        maximumSwitchLatency = latency;
+    }
+    totalSwitchLatency += latency;
+    switchesCount++;
+}
+
+static void switchTo(struct Task *next) {
+    /* the switched out task resumes from saveContext with 1 */
+    struct Task *previous = currentTask;
+
+    previous->process = getCurrentProcess();
+    next->state = TASK_RUNNING;
+    next->sliceTicks = TASK_TIME_SLICE;
+    next->switches++;
+    currentTask = next;
+
+    logTrace(LOG_SCHED, ("sched: %s -> %s\n", previous->name, next->name));
+
+    switchStart = readTimerCounter();
+    if(saveContext(&previous->context) == 0) {
+        setCurrentProcess(next->process);
+        restoreContext(&next->context, 1);
+    }
+    measureSwitchLatency();
+}
+
+static void schedule(void) {
+    /* the current task is already queued, blocked or finished,
+       every queued task is resident */
+    struct Task *next = dequeueReady();
+    if(!next) {
+        return;
+    }
+    if(next == currentTask) {
+        next->state = TASK_RUNNING;
+        next->sliceTicks = TASK_TIME_SLICE;
+        return;
+    }
+    switchTo(next);
+}
+
+static void taskStart(void) {
+    /* first instruction of every new task, @see createTask */
+    measureSwitchLatency();
+    currentTask->entry(currentTask->argument);
+    exitTask();
+}
+
+static void reapFinishedTasks(void) {
+    /* a task can't free the stack it runs on */
+    register unsigned int index;
+    for(index = 0; index < SCHEDULER_TASKS; index++) {
+        if(tasks[index].state == TASK_FINISHED && &tasks[index] != currentTask) {
+            kfree(tasks[index].stack);
+            tasks[index].stack = NULL;
+            tasks[index].state = TASK_UNUSED;
+        }
+    }
+}
+
+static void swapperTask(void *argument) {
+    /* swaps the woken processes back in, in order. Blocked processes make
+       room when the memory is in use, otherwise the swap in waits for
+       retrySwapIns */
+    struct Task *task;
+    (void)argument;
+    while(1) {
+        while(swapInHead) {
+            task = swapInHead;
+            if(swapInProcess(task->process) != SUCCESS &&
+               (!swapOutBlockedTasks() || swapInProcess(task->process) != SUCCESS)) {
+                break;
+            }
+            swapInHead = task->next;
+            if(!swapInHead) {
+                swapInTail = NULL;
+            }
+            enqueueReady(task);
+        }
+        waitEvent(&swapEvent);
+    }
+}
+
+static void idleTask(void *argument) {
+    (void)argument;
+    while(1) {
+        reapFinishedTasks();
+        if(keyboardEvent.waiters && isKeyAvailable()) {
+            signalEvent(&keyboardEvent);
+        }
+        if(getReadyPriority() == TASK_PRIORITIES) {
+            /* the logger is drained before halting */
+            if(!drainLogger(LOGGER_DRAIN_IDLE)) {
+                asm hlt /* nothing to run until the next interrupt */
+            }
+        }
+        else {
+            yield();
+        }
+    }
+}
+
+struct Task *createTask(char *name, void (*entry)(void *argument), void *argument, unsigned int stackSize,
+                        enum TASK_PRIORITY priority) {
+    static unsigned int taskId = 0;
+    struct Task *task = NULL;
+    register unsigned int index;
+    unsigned long stackAddress;
+    unsigned long kernelAddress = (unsigned long)_DS << 4;
+
+    for(index = 0; index < SCHEDULER_TASKS; index++) {
+        if(tasks[index].state == TASK_UNUSED) {
+            task = &tasks[index];
+            break;
+        }
+    }
+    if(!task) {
+        return NULL;
+    }
+
+    task->stack = kmalloc(stackSize);
+    if(!task->stack) {
+        return NULL;
+    }
+    stackAddress = convertFarPointerToLinearAddress(task->stack);
+    if(stackAddress + stackSize > kernelAddress + 0x10000UL) {
+        kfree(task->stack);
+        task->stack = NULL;
+        return NULL;
+    }
+
+    task->taskId = ++taskId;
+    task->name = name;
+    task->entry = entry;
+    task->argument = argument;
+    task->process = NULL;
+    task->priority = priority;
+    task->cpuTicks = 0;
+    task->switches = 0;
+
+    /* restoreContext "returns" into taskStart on the new stack */
+    memset((void far *)&task->context, NULL, sizeof(struct Context));
+    task->context.stackPointer = (unsigned int)(stackAddress - kernelAddress + stackSize) & ~1;
+    task->context.stackSegment = _DS;
+    task->context.dataSegment = _DS;
+    task->context.extraSegment = _DS;
+    task->context.instructionPointer = (unsigned int)taskStart;
+    task->context.flags = TASK_FLAGS;
+
+    logTrace(LOG_SCHED, ("sched: create task %s id=%d stack @ %x\n", name, task->taskId,
+                         task->context.stackPointer));
+
+    enqueueReady(task);
+    return task;
+}
+
+struct Task *getCurrentTask(void) {
+    return currentTask;
+}
+
+void yield(void) {
+    if(!currentTask || getReadyPriority() == TASK_PRIORITIES) {
+        return;
+    }
+    enqueueReady(currentTask);
+    schedule();
+}
+
+void schedulerTick(unsigned int codeSegment) {
+    /* called by the timer interrupt with the interrupted code segment */
+    enum TASK_PRIORITY priority;
+    if(!currentTask) {
+        return;
+    }
+    currentTask->cpuTicks++;
+    if(currentTask->sliceTicks) {
+        currentTask->sliceTicks--;
+    }
+
+    if(codeSegment == _CS || codeSegment >= USER_SEGMENT_LIMIT) {
+        return;
+    }
+
+    priority = getReadyPriority();
+    if(priority < currentTask->priority ||
+       (priority == currentTask->priority && currentTask->sliceTicks == 0)) {
+        enqueueReady(currentTask);
+        schedule();
+    }
+}
+
+unsigned int swapOutBlockedTasks(void) {
+    /* blocked tasks don't touch their process memory until signaled */
+    register unsigned int index;
+    unsigned int count = 0;
+    for(index = 0; index < SCHEDULER_TASKS; index++) {
+        if(tasks[index].state == TASK_BLOCKED && tasks[index].process &&
+           swapOutProcess(tasks[index].process) == SUCCESS) {
+            count++;
+        }
+    }
+    return count;
+}
+
+void exitTask(void) {
+    if(!currentTask->stack) {
+        return; /* the boot task runs the shell, it never ends */
+    }
+    currentTask->state = TASK_FINISHED;
+    schedule();
+}
+
+void waitEvent(struct Event *event) {
+    struct Task *task;
+    if(event->isSignaled) {
+        event->isSignaled = 0;
+        return;
+    }
+
+    currentTask->state = TASK_BLOCKED;
+    currentTask->next = NULL;
+    if(!event->waiters) {
+        event->waiters = currentTask;
+    }
+    else {
+        for(task = event->waiters; task->next; task = task->next);
+        task->next = currentTask;
+    }
+    schedule();
+}
+
+void signalEvent(struct Event *event) {
+    /* the tasks of swapped out processes stay blocked for the swapper */
+    struct Task *task;
+    unsigned int isSwapInQueued = 0;
+    if(!event->waiters) {
+        event->isSignaled = 1;
+        return;
+    }
+    while(event->waiters) {
+        task = event->waiters;
+        event->waiters = task->next;
+        if(!task->process || !task->process->swapImage) {
+            enqueueReady(task);
+            continue;
+        }
+        task->next = NULL;
+        if(swapInTail) {
+            swapInTail->next = task;
+        }
+        else {
+            swapInHead = task;
+        }
+        swapInTail = task;
+        isSwapInQueued = 1;
+    }
+    if(isSwapInQueued) {
+        signalEvent(&swapEvent);
+    }
+}
+
+void retrySwapIns(void) {
+    /* memory was freed, a deferred swap in may fit now */
+    if(swapInHead) {
+        signalEvent(&swapEvent);
+    }
+}
+
+unsigned char waitKeyboard(void) {
+    /* other tasks run until the idle task sees a key */
+    while(!isKeyAvailable()) {
+        waitEvent(&keyboardEvent);
+    }
+    return readCharacter();
+}
+
+void dumpTasks(enum PRINT_STREAM stream) {
+    static char *states[] = {"unused", "ready", "running", "blocked", "finished"};
+    register unsigned int index;
+    printFormat(stream, "Tasks:\n");
+    for(index = 0; index < SCHEDULER_TASKS; index++) {
+        if(tasks[index].state != TASK_UNUSED) {
+            printFormat(stream, "\t%d %s: %s priority=%d ticks=%lu switches=%d\n", tasks[index].taskId,
+                        tasks[index].name, states[tasks[index].state], tasks[index].priority,
+                        tasks[index].cpuTicks, tasks[index].switches);
+        }
+    }
+    printFormat(stream, "Switch latency (PIT counts): last=%d maximum=%d average=%d\n",
+                lastSwitchLatency, maximumSwitchLatency,
+                switchesCount ? (unsigned int)(totalSwitchLatency / switchesCount) : 0);
+}
+
+void initializeScheduler(void) {
+    /* the boot task is the running kernel, it uses the kernel stack */
+    memset((void far *)tasks, NULL, sizeof(tasks));
+    memset((void far *)&keyboardEvent, NULL, sizeof(struct Event));
+    memset((void far *)&swapEvent, NULL, sizeof(struct Event));
+    swapInHead = NULL;
+    swapInTail = NULL;
+    memset((void far *)readyHead, NULL, sizeof(readyHead));
+    memset((void far *)readyTail, NULL, sizeof(readyTail));
+    tasks[0].name = "kernel";
+    tasks[0].state = TASK_RUNNING;
+    tasks[0].priority = PRIORITY_NORMAL;
+    currentTask = &tasks[0];
+
+    (void)createTask("idle", idleTask, NULL, TASK_STACK_SIZE, PRIORITY_IDLE);
+    (void)createTask("swapper", swapperTask, NULL, SWAPPER_STACK_SIZE, PRIORITY_HIGH);
+}
\ No newline at end of file
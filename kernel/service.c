@@ -25,62 +25,737 @@
 */
 #include <kernel/service.h>
 #include <kernel/version.h> /* MAJOR_VERSION, MINOR_VERSION */
-#include <conio.h> /* printFormat */
+#include <kernel/memory.h> /* getHeapStatistics */
+#include <kernel/process.h> /* getCurrentProcess, exitCurrentProcess, setProcessVector */
+#include <kernel/sched.h> /* yield, waitKeyboard */
+#include <kernel/pheap.h> /* allocateParagraphs, freeParagraphs, resizeParagraphs */
+#include <kernel/disk.h> /* SUCCESS, FAILURE */
+#include <kernel/filesys.h> /* fopen, fclose, readFile, FileStatus */
+#include <kernel/context.h> /* callOnKernelStack */
+#include <kernel/exec.h> /* spawnProgram, waitProgram */
+#include <kernel/timer.h> /* TIMER_INTERRUPT, readTimerCounter, getTimerTicks */
+#include <conio.h> /* printFormat, printCharacter, writeStream, flushConsole */
 #include <vector.h> /* setInterruptVector */
-#include <string.h> /* MK_FP */
-#ifdef SERVICE_DEBUG
-    #include <kernel/debug.h>
-#endif
+#include <string.h> /* MK_FP, memset, movedata, getStringLength */
+#include <kernel/log.h> /* logWarning, logTrace, setLogMask */
 
-void initializeInterrupt(void) {
-    setInterruptVector(KERNEL_INTERRUPT, kernelInterruptHandler);
-    setInterruptVector(DOS_INTERRUPT, DOSInterruptHandler);
+static unsigned char kernelStack[KERNEL_STACK_SIZE];
+static struct FileRequest fileRequest;
+static char filePath[FILE_PATH_SIZE];
+static char dosPath[FILE_PATH_SIZE];
+static struct KernelService services[KERNEL_SERVICES];
+
+static void interrupt programTerminateHandler(void) {
+    /* INT 20h, com programs return to PSP:0 */
+    exitCurrentProcess(0);
+}
+
+static struct File far *getProcessFile(struct Process far *process, unsigned int handle) {
+    return handle < PROCESS_FILES ? process->files[handle] : NULL;
+}
+
+static int fileService(void) {
+    /* runs on the kernel stack, fopen and the FAT12 code use near
+       pointers to their locals. Reads go straight to the caller buffer */
+    struct Process far *process = getCurrentProcess();
+    struct FileStatus far *status;
+    struct File far *file = NULL;
+    char far *path;
+    unsigned int index;
+    unsigned long position;
+
+    fileRequest.error = DOS_ERROR_INVALID_HANDLE;
+    if(!process) {
+        return FAILURE;
+    }
+    if(fileRequest.function != API_FILE_OPEN) {
+        file = getProcessFile(process, fileRequest.handle);
+        if(!file) {
+            return FAILURE;
+        }
+    }
+
+    switch(fileRequest.function) {
+        case API_FILE_OPEN:
+            path = (char far *)fileRequest.address;
+            for(index = 0; index < FILE_PATH_SIZE - 1 && path[index]; index++) {
+                filePath[index] = path[index];
+            }
+            filePath[index] = '\0';
+            for(fileRequest.handle = 0; fileRequest.handle < PROCESS_FILES; fileRequest.handle++) {
+                if(!process->files[fileRequest.handle]) {
+                    break;
+                }
+            }
+            if(fileRequest.handle == PROCESS_FILES) {
+                fileRequest.error = DOS_ERROR_TOO_MANY_FILES;
+                return FAILURE;
+            }
+            fileRequest.error = DOS_ERROR_FILE_NOT_FOUND;
+            if(path[index]) {
+                return FAILURE;
+            }
+            file = fopen(filePath);
+            if(!file) {
+                return FAILURE;
+            }
+            process->files[fileRequest.handle] = file;
+            fileRequest.result = fileRequest.handle;
+            break;
+
+        case API_FILE_READ:
+            fileRequest.result = readFile(file, file->position, fileRequest.address, fileRequest.count);
+            file->position += fileRequest.result;
+            break;
+
+        case API_FILE_SEEK:
+            switch(fileRequest.origin) {
+                case 0:
+                    position = 0;
+                    break;
+                case 1:
+                    position = file->position;
+                    break;
+                case 2:
+                    position = file->size;
+                    break;
+                default:
+                    fileRequest.error = DOS_ERROR_INVALID_FUNCTION;
+                    return FAILURE;
+            }
+            if((long)fileRequest.offset < 0 && (unsigned long)-(long)fileRequest.offset > position) {
+                fileRequest.error = DOS_ERROR_INVALID_FUNCTION;
+                return FAILURE; /* before the start of the file */
+            }
+            position += fileRequest.offset;
+            file->position = position;
+            fileRequest.result = position;
+            break;
+
+        case API_FILE_CLOSE:
+            process->files[fileRequest.handle] = NULL;
+            fclose(file);
+            fileRequest.result = 0;
+            break;
+
+        case API_FILE_STAT:
+            status = (struct FileStatus far *)fileRequest.address;
+            movedata(FP_SEG(file->name), FP_OFF(file->name), FP_SEG(status->name), FP_OFF(status->name),
+                     FILE_NAME_SIZE);
+            movedata(FP_SEG(file->extension), FP_OFF(file->extension),
+                     FP_SEG(status->extension), FP_OFF(status->extension), FILE_EXTENSION_SIZE);
+            status->size = file->size;
+            status->lastWriteTime = file->lastWriteTime;
+            status->lastWriteDate = file->lastWriteDate;
+            fileRequest.result = 0;
+            break;
+
+        default:
+            fileRequest.error = DOS_ERROR_INVALID_FUNCTION;
+            return FAILURE;
+    }
+    return SUCCESS;
+}
+
+static int callFileService(void) {
+    return callOnKernelStack(fileService, kernelStack + KERNEL_STACK_SIZE);
+}
+
+static int convertDOSPath(char far *path) {
+    /* A:\DIR\NAME.EXT to the NOS path /DIR        /NAME    EXT, there is
+       no current directory so relative paths start from the root */
+    unsigned int index = 0;
+    unsigned int length = 0;
+    unsigned int count;
+
+    if(path[0] && path[1] == ':') {
+        path += 2;
+    }
+    while(*path) {
+        if(*path == '\\' || *path == '/') {
+            path++;
+            continue;
+        }
+        if(length + 1 + 8 + 3 >= FILE_PATH_SIZE) {
+            return FAILURE;
+        }
+        dosPath[length++] = '/';
+        for(count = 0; *path && *path != '.' && *path != '\\' && *path != '/'; count++) {
+            if(count == 8) {
+                return FAILURE;
+            }
+            dosPath[length + count] = *path++;
+        }
+        for(; count < 8; count++) {
+            dosPath[length + count] = ' ';
+        }
+        length += 8;
+        if(*path == '.') {
+            path++;
+        }
+        for(count = 0; *path && *path != '\\' && *path != '/'; count++) {
+            if(count == 3) {
+                return FAILURE;
+            }
+            dosPath[length + count] = *path++;
+        }
+        for(; count < 3; count++) {
+            dosPath[length + count] = ' ';
+        }
+        length += 3;
+        index++;
+    }
+    dosPath[length] = '\0';
+    return index ? SUCCESS : FAILURE;
+}
+
+static unsigned int readConsole(char far *buffer, unsigned int size) {
+    /* cooked DOS input: echo, backspace, the line ends with CR LF */
+    unsigned int count = 0;
+    unsigned char character;
+
+    while(count < size) {
+        character = waitKeyboard();
+        if(character == '\b') {
+            if(count) {
+                count--;
+                printString(STDOUT, "\b \b");
+            }
+            continue;
+        }
+        if(character == '\r') {
+            printString(STDOUT, "\r\n");
+            buffer[count++] = '\r';
+            if(count < size) {
+                buffer[count++] = '\n';
+            }
+            break;
+        }
+        printCharacter(STDOUT, character);
+        buffer[count++] = character;
+    }
+    flushConsole();
+    return count;
+}
+
+static int isKernelVector(unsigned int vector) {
+    return vector == KERNEL_INTERRUPT || vector == DOS_INTERRUPT ||
+           vector == PROGRAM_TERMINATE_INTERRUPT || vector == TIMER_INTERRUPT;
 }
 
 #pragma argsused
 static void interrupt DOSInterruptHandler(unsigned int BP, unsigned int DI, unsigned int SI, unsigned int DS,
                                           unsigned int ES, unsigned int DX, unsigned int CX, unsigned int BX,
                                           unsigned int AX, unsigned int IP, unsigned int CS, unsigned int FLAGS) {
-    /* Wrapper interrupt to report DOS for future support */
-    #ifdef SERVICE_DEBUG
-        printFormat(LOGGER, "DOS service 0x21: AX=%x\n", AX);
-    #endif
+    /* the INT 21h subset used by the Turbo C runtime: console output,
+       read only files on the FAT, memory and exit. Handles from
+       DOS_FILE_HANDLE_BASE map to the process file handles */
+    static unsigned int largest;
+    struct Process far *process = getCurrentProcess();
+    char far *string;
+    unsigned long far *vector;
+    unsigned int index;
+    unsigned int error = 0;
+    int program;
+    logTrace(LOG_SVC, ("DOS service 0x21: AX=%x\n", AX));
     switch(AX >> 8) {
         case 0:
+            exitCurrentProcess(0);
+            break;
+
+        case 0x02:
+            /* DL=character */
+            printCharacter(STDOUT, DX & 0xff);
+            flushConsole();
+            AX = (AX & 0xff00) | (DX & 0xff);
+            break;
+
+        case 0x09:
+            /* DS:DX=string ending with $ */
+            string = (char far *)MK_FP(DS, DX);
+            for(index = 0; string[index] != '$'; index++);
+            writeStream(STDOUT, string, index);
+            AX = (AX & 0xff00) | '$';
+            break;
+
+        case 0x25:
+            /* AL=vector, DS:DX=handler. The kernel vectors are kept, the
+               others are restored by destroyProcess */
+            if(!isKernelVector(AX & 0xff) &&
+               setProcessVector(process, AX & 0xff, ((unsigned long)DS << 16) | DX) != SUCCESS) {
+                logWarning(LOG_SVC, ("DOS service 0x21: vector %x kept, %d vectors are set\n",
+                                     AX & 0xff, PROCESS_VECTORS));
+            }
+            break;
+
+        case 0x30:
+            AX = DOS_VERSION;
+            BX = 0;
+            CX = 0;
+            break;
+
+        case 0x35:
+            /* AL=vector, returns ES:BX=handler */
+            vector = (unsigned long far *)MK_FP(0, (AX & 0xff) << 2);
+            ES = (unsigned int)(*vector >> 16);
+            BX = (unsigned int)*vector;
+            break;
+
+        case 0x3d:
+            /* DS:DX=path, AL=access mode, returns AX=handle */
+            if(AX & 0x07) {
+                error = DOS_ERROR_ACCESS_DENIED; /* read only file system */
+            }
+            else if(convertDOSPath((char far *)MK_FP(DS, DX)) != SUCCESS) {
+                error = DOS_ERROR_FILE_NOT_FOUND;
+            }
+            else {
+                fileRequest.function = API_FILE_OPEN;
+                fileRequest.address = (void far *)dosPath;
+                if(callFileService() == SUCCESS) {
+                    AX = (unsigned int)fileRequest.result + DOS_FILE_HANDLE_BASE;
+                }
+                else {
+                    error = fileRequest.error;
+                }
+            }
+            break;
+
+        case 0x3e:
+            /* BX=handle, the standard handles stay open */
+            if(BX >= DOS_FILE_HANDLE_BASE) {
+                fileRequest.function = API_FILE_CLOSE;
+                fileRequest.handle = BX - DOS_FILE_HANDLE_BASE;
+                if(callFileService() != SUCCESS) {
+                    error = fileRequest.error;
+                }
+            }
+            break;
+
+        case 0x3f:
+            /* BX=handle, CX=size, DS:DX=buffer, returns AX=bytes read */
+            if(BX == DOS_STDIN) {
+                AX = readConsole((char far *)MK_FP(DS, DX), CX);
+            }
+            else if(BX < DOS_FILE_HANDLE_BASE) {
+                AX = 0;
+            }
+            else {
+                fileRequest.function = API_FILE_READ;
+                fileRequest.handle = BX - DOS_FILE_HANDLE_BASE;
+                fileRequest.address = MK_FP(DS, DX);
+                fileRequest.count = CX;
+                if(callFileService() == SUCCESS) {
+                    AX = (unsigned int)fileRequest.result;
+                }
+                else {
+                    error = fileRequest.error;
+                }
+            }
+            break;
+
+        case 0x40:
+            /* BX=handle, CX=size, DS:DX=buffer, returns AX=bytes written */
+            if(BX == DOS_STDOUT || BX == DOS_STDERR) {
+                writeStream(STDOUT, (char far *)MK_FP(DS, DX), CX);
+                AX = CX;
+            }
+            else if(BX < DOS_FILE_HANDLE_BASE) {
+                AX = CX; /* aux and prn are discarded */
+            }
+            else {
+                error = process && getProcessFile(process, BX - DOS_FILE_HANDLE_BASE) ?
+                        DOS_ERROR_ACCESS_DENIED : DOS_ERROR_INVALID_HANDLE;
+            }
+            break;
+
+        case 0x42:
+            /* BX=handle, AL=origin, CX:DX=offset, returns DX:AX=position */
+            if(BX < DOS_FILE_HANDLE_BASE) {
+                error = DOS_ERROR_INVALID_HANDLE;
+            }
+            else {
+                fileRequest.function = API_FILE_SEEK;
+                fileRequest.handle = BX - DOS_FILE_HANDLE_BASE;
+                fileRequest.origin = AX & 0xff;
+                fileRequest.offset = ((unsigned long)CX << 16) | DX;
+                if(callFileService() == SUCCESS) {
+                    AX = (unsigned int)fileRequest.result;
+                    DX = (unsigned int)(fileRequest.result >> 16);
+                }
+                else {
+                    error = fileRequest.error;
+                }
+            }
+            break;
+
+        case 0x44:
+            /* AL=0 get device information, BX=handle, returns DX */
+            if((AX & 0xff) != 0) {
+                error = DOS_ERROR_INVALID_FUNCTION;
+            }
+            else if(BX < DOS_FILE_HANDLE_BASE) {
+                DX = DOS_DEVICE_CONSOLE;
+            }
+            else if(process && getProcessFile(process, BX - DOS_FILE_HANDLE_BASE)) {
+                DX = 0; /* disk file on drive A */
+            }
+            else {
+                error = DOS_ERROR_INVALID_HANDLE;
+            }
+            break;
+
+        case 0x48:
+            /* BX=paragraphs, returns AX=segment or BX=largest block */
+            AX = process ? allocateParagraphs(&process->heap, &process->arena, BX, &largest) : 0;
+            if(!AX) {
+                error = DOS_ERROR_INSUFFICIENT_MEMORY;
+                BX = process ? largest : 0;
+            }
+            break;
+
+        case 0x49:
+            /* ES=segment */
+            if(!process || freeParagraphs(&process->heap, ES) != SUCCESS) {
+                error = DOS_ERROR_INVALID_BLOCK;
+            }
+            break;
+
+        case 0x4a:
+            /* ES=segment, BX=paragraphs, in place only. The program image
+               can't grow, shrinking it keeps the memory until exit */
+            if(!process) {
+                error = DOS_ERROR_INVALID_BLOCK;
+            }
+            else if(ES == process->imageSegment) {
+                if(BX > process->imageParagraphs) {
+                    error = DOS_ERROR_INSUFFICIENT_MEMORY;
+                    BX = process->imageParagraphs;
+                }
+            }
+            else if(resizeParagraphs(&process->heap, ES, BX, &largest) != SUCCESS) {
+                error = largest ? DOS_ERROR_INSUFFICIENT_MEMORY : DOS_ERROR_INVALID_BLOCK;
+                BX = largest;
+            }
+            break;
+
+        case 0x4b:
+            /* AL=0 load and execute DS:DX, ES:BX (parameter block) is not
+               used. The child runs on a program task while the caller waits */
+            if(!process || (AX & 0xff) != 0) {
+                error = DOS_ERROR_INVALID_FUNCTION;
+            }
+            else if(convertDOSPath((char far *)MK_FP(DS, DX)) != SUCCESS) {
+                error = DOS_ERROR_FILE_NOT_FOUND;
+            }
+            else if((program = spawnProgram(dosPath)) < 0) {
+                error = DOS_ERROR_INSUFFICIENT_MEMORY; /* every program task is busy */
+            }
+            else {
+                process->childExitCode = waitProgram(program);
+                switch(process->childExitCode) {
+                    case -1:
+                        error = DOS_ERROR_FILE_NOT_FOUND;
+                        break;
+                    case -2:
+                        error = DOS_ERROR_INVALID_FORMAT;
+                        break;
+                    case -3:
+                        error = DOS_ERROR_INSUFFICIENT_MEMORY;
+                        break;
+                }
+            }
+            break;
+
         case 0x4c:
-            printFormat(LOGGER, "DOS terminate with value %x\n", AX & 0xf);
+            logTrace(LOG_SVC, ("DOS terminate with value %x\n", AX & 0xff));
+            exitCurrentProcess(AX & 0xff);
+            break;
+
+        case 0x4d:
+            /* returns AL=exit code of the last 4Bh child, AH=0 normal termination */
+            AX = process && process->childExitCode > 0 ? process->childExitCode & 0xff : 0;
             break;
+
+        default:
+            logWarning(LOG_SVC, ("DOS service %x is not supported\n", AX >> 8));
+            error = DOS_ERROR_INVALID_FUNCTION;
+            break;
+    }
+
+    if(error) {
+        AX = error;
+        FLAGS |= CARRY_FLAG;
+    }
+    else {
+        FLAGS &= ~CARRY_FLAG;
+    }
+}
+
+static void kernelVersionService(struct ServiceRegisters far *registers) {
+    registers->CX = (MAJOR_VERSION << 8) + MINOR_VERSION;
+}
+
+static void mallocService(struct ServiceRegisters far *registers) {
+    /* CX=size in bytes, returns ES:BX=segment:0 (0:0 on failure) */
+    static unsigned int largest;
+    struct Process far *process = getCurrentProcess();
+    registers->ES = 0;
+    if(process && registers->CX) {
+        registers->ES = allocateParagraphs(&process->heap, &process->arena,
+                                           (unsigned int)(((unsigned long)registers->CX + 15) >> 4), &largest);
+    }
+    registers->BX = 0;
+}
+
+static void freeService(struct ServiceRegisters far *registers) {
+    /* ES:BX from API_MALLOC, the rest is released with the process on exit */
+    struct Process far *process = getCurrentProcess();
+    if(process && registers->BX == 0) {
+        (void)freeParagraphs(&process->heap, registers->ES);
+    }
+}
+
+static void printService(struct ServiceRegisters far *registers) {
+    char far *string = (char far *)MK_FP(registers->ES, registers->BX);
+    writeStream(STDOUT, string, getStringLength(string));
+}
+
+static void writeService(struct ServiceRegisters far *registers) {
+    /* AL=stream, ES:BX=buffer, CX=length */
+    if((registers->AX & 0xff) > LOGGER) {
+        registers->AX = DOS_ERROR_INVALID_HANDLE;
+        registers->FLAGS |= CARRY_FLAG;
+        return;
+    }
+    writeStream((enum PRINT_STREAM)(registers->AX & 0xff), (char far *)MK_FP(registers->ES, registers->BX),
+                registers->CX);
+    registers->FLAGS &= ~CARRY_FLAG;
+}
+
+static void heapStatisticsService(struct ServiceRegisters far *registers) {
+    /* ES:BX points to struct HeapStatistics */
+    getHeapStatistics((struct HeapStatistics far *)MK_FP(registers->ES, registers->BX));
+}
+
+static void exitService(struct ServiceRegisters far *registers) {
+    /* AL=exit code, doesn't return */
+    exitCurrentProcess(registers->AX & 0xff);
+}
+
+#pragma argsused
+static void yieldService(struct ServiceRegisters far *registers) {
+    yield();
+}
+
+static void readCharacterService(struct ServiceRegisters far *registers) {
+    /* returns AL=character, other tasks run while waiting */
+    registers->AX = waitKeyboard();
+}
+
+static void fileCallService(struct ServiceRegisters far *registers) {
+    fileRequest.function = registers->AX >> 8;
+    fileRequest.origin = registers->AX & 0xff;
+    fileRequest.handle = registers->DX;
+    fileRequest.address = MK_FP(registers->ES, registers->BX);
+    fileRequest.count = registers->CX;
+    fileRequest.offset = ((unsigned long)registers->CX << 16) | registers->BX;
+    if(callFileService() == SUCCESS) {
+        registers->AX = (unsigned int)fileRequest.result;
+        if(fileRequest.function == API_FILE_SEEK) {
+            registers->DX = (unsigned int)(fileRequest.result >> 16);
+        }
+        registers->FLAGS &= ~CARRY_FLAG;
+    }
+    else {
+        registers->AX = fileRequest.error;
+        registers->FLAGS |= CARRY_FLAG;
+    }
+}
+
+static void serviceStatisticsService(struct ServiceRegisters far *registers) {
+    /* CX=function, ES:BX points to struct ServiceStatistics */
+    if(getServiceStatistics(registers->CX, (struct ServiceStatistics far *)MK_FP(registers->ES, registers->BX)) ==
+       SUCCESS) {
+        registers->FLAGS &= ~CARRY_FLAG;
+    }
+    else {
+        registers->AX = DOS_ERROR_INVALID_FUNCTION;
+        registers->FLAGS |= CARRY_FLAG;
+    }
+}
+
+static void logMaskService(struct ServiceRegisters far *registers) {
+    /* AL=level, BL=subsystems @see kernel/log.h */
+    if((registers->AX & 0xff) >= LOG_LEVELS) {
+        registers->AX = DOS_ERROR_INVALID_FUNCTION;
+        registers->FLAGS |= CARRY_FLAG;
+        return;
+    }
+    registers->AX = setLogMask(registers->AX & 0xff, registers->BX & 0xff);
+    registers->FLAGS &= ~CARRY_FLAG;
+}
+
+int registerService(unsigned int function, char *name, void (*handler)(struct ServiceRegisters far *registers)) {
+    struct KernelService *service;
+    unsigned int index;
+
+    if(function >= KERNEL_SERVICES || services[function].handler) {
+        return FAILURE;
+    }
+    service = &services[function];
+    memset(service, NULL, sizeof(struct KernelService));
+    for(index = 0; index < SERVICE_NAME_SIZE - 1 && name[index]; index++) {
+        service->statistics.name[index] = name[index];
+    }
+    service->handler = handler;
+    return SUCCESS;
+}
+
+int getServiceStatistics(unsigned int function, struct ServiceStatistics far *statistics) {
+    if(function >= KERNEL_SERVICES || !services[function].handler) {
+        return FAILURE;
+    }
+    movedata(_DS, (unsigned int)&services[function].statistics, FP_SEG(statistics), FP_OFF(statistics),
+             sizeof(struct ServiceStatistics));
+    return SUCCESS;
+}
+
+void dumpServiceStatistics(enum PRINT_STREAM stream) {
+    register unsigned int function;
+    register unsigned int bucket;
+    struct ServiceStatistics *statistics;
+
+    printFormat(stream, "Kernel services (latency in PIT counts, buckets from <%d doubling):\n",
+                SERVICE_LATENCY_FIRST_BOUND);
+    for(function = 0; function < KERNEL_SERVICES; function++) {
+        statistics = &services[function].statistics;
+        if(!services[function].handler || !statistics->calls) {
+            continue;
+        }
+        printFormat(stream, "\t%d %s: calls=%lu maximum=%lu average=%lu\n", function, statistics->name,
+                    statistics->calls, statistics->maximumLatency, statistics->totalLatency / statistics->calls);
+        printFormat(stream, "\t\t");
+        for(bucket = 0; bucket < SERVICE_LATENCY_BUCKETS; bucket++) {
+            printFormat(stream, "%lu ", statistics->histogram[bucket]);
+        }
+        printFormat(stream, "\n");
     }
 }
 
+static unsigned long getElapsedCounts(unsigned long startTicks, unsigned int startCounter) {
+    /* the counter goes down and reloads with the divisor every tick, a
+       reload without a counted tick (IF is clear in the services) adds
+       one period */
+    unsigned int counter = readTimerCounter();
+    unsigned long divisor = getTimerDivisor();
+    unsigned long elapsed = (getTimerTicks() - startTicks) * divisor + startCounter - counter;
+
+    if((long)elapsed < 0) {
+        elapsed += divisor;
+    }
+    return elapsed;
+}
+
+static void recordServiceLatency(struct ServiceStatistics *statistics, unsigned long latency) {
+    unsigned long bound = SERVICE_LATENCY_FIRST_BOUND;
+    unsigned int bucket = 0;
+
+    while(bucket < SERVICE_LATENCY_BUCKETS - 1 && latency >= bound) {
+        bound <<= 1;
+        bucket++;
+    }
+    statistics->calls++;
+    statistics->totalLatency += latency;
+    if(latency > statistics->maximumLatency) {
+        statistics->maximumLatency = latency;
+    }
+    statistics->histogram[bucket]++;
+}
+
+void dispatchService(struct ServiceRegisters far *registers) {
+    /* AH indexes the service table, the time to the handler return is
+       recorded. The time of blocking calls includes the tasks that ran
+       meanwhile */
+    struct KernelService *service;
+    unsigned long startTicks;
+    unsigned int startCounter;
+    unsigned int function = registers->AX >> 8;
+
+    if(function >= KERNEL_SERVICES || !services[function].handler) {
+        logWarning(LOG_SVC, ("Kernel service %x is not registered\n", function));
+        registers->AX = DOS_ERROR_INVALID_FUNCTION;
+        registers->FLAGS |= CARRY_FLAG;
+        return;
+    }
+    service = &services[function];
+    startTicks = getTimerTicks();
+    startCounter = readTimerCounter();
+    service->handler(registers);
+    recordServiceLatency(&service->statistics, getElapsedCounts(startTicks, startCounter));
+}
+
 #pragma argsused
 static void interrupt kernelInterruptHandler(unsigned int BP, unsigned int DI, unsigned int SI, unsigned int DS,
                                              unsigned int ES, unsigned int DX, unsigned int CX, unsigned int BX,
                                              unsigned int AX, unsigned int IP, unsigned int CS, unsigned int FLAGS) {
-    char far *string;
-    switch(AX >> 8) { /* AH */
-        case API_KERNEL_VERSION:
-            CX = (MAJOR_VERSION << 8) + MINOR_VERSION;
-            break;
+    /* the handler gets the interrupt frame on the caller stack,
+       farServiceEntry builds the same frame */
+    dispatchService((struct ServiceRegisters far *)MK_FP(_SS, (unsigned int)&BP));
+}
 
-        case API_MALLOC:
-            /* TODO */
-            break;
+#ifdef SERVICE_ENTRY_BENCHMARK
+void measureServiceEntry(enum PRINT_STREAM stream) {
+    /* API_KERNEL_VERSION through both entries, the dispatch and the
+       handler are the same so the difference is the entry cost */
+    static unsigned long entryVector;
+    unsigned long elapsed[2];
+    unsigned long startTicks;
+    unsigned int startCounter;
+    unsigned int index;
 
-        case API_FREE:
-            /* TODO */
-            break;
-
-        case API_STDOUT_PRINT:
-            #ifdef SERVICE_DEBUG
-            DebugBreak();
-            #endif
-            string = (char far *)MK_FP(ES, BX);
-            while(*string) {
-                printCharacter(STDOUT, *string++);
-            }
-            break;
+    entryVector = *(unsigned long far *)MK_FP(0, SERVICE_ENTRY_VECTOR << 2);
+    startTicks = getTimerTicks();
+    startCounter = readTimerCounter();
+    for(index = 0; index < SERVICE_ENTRY_CALLS; index++) {
+        _AX = API_KERNEL_VERSION << 8;
+        asm int KERNEL_INTERRUPT
+    }
+    elapsed[0] = getElapsedCounts(startTicks, startCounter);
 
-        /* TODO: add filesystem API */
+    startTicks = getTimerTicks();
+    startCounter = readTimerCounter();
+    for(index = 0; index < SERVICE_ENTRY_CALLS; index++) {
+        _AX = API_KERNEL_VERSION << 8;
+        asm call dword ptr entryVector
     }
+    elapsed[1] = getElapsedCounts(startTicks, startCounter);
+
+    printFormat(stream, "Service entry, PIT counts per %d calls: int=%lu far call=%lu\n", SERVICE_ENTRY_CALLS,
+                elapsed[0], elapsed[1]);
+}
+#endif
+
+void initializeInterrupt(void) {
+    registerService(API_KERNEL_VERSION, "version", kernelVersionService);
+    registerService(API_MALLOC, "malloc", mallocService);
+    registerService(API_FREE, "free", freeService);
+    registerService(API_STDOUT_PRINT, "print", printService);
+    registerService(API_STDOUT_WRITE, "write", writeService);
+    registerService(API_HEAP_STATISTICS, "heap", heapStatisticsService);
+    registerService(API_EXIT, "exit", exitService);
+    registerService(API_YIELD, "yield", yieldService);
+    registerService(API_READ_CHARACTER, "getch", readCharacterService);
+    registerService(API_FILE_OPEN, "open", fileCallService);
+    registerService(API_FILE_READ, "read", fileCallService);
+    registerService(API_FILE_SEEK, "seek", fileCallService);
+    registerService(API_FILE_CLOSE, "close", fileCallService);
+    registerService(API_FILE_STAT, "stat", fileCallService);
+    registerService(API_SERVICE_STATISTICS, "statistics", serviceStatisticsService);
+    registerService(API_LOG_MASK, "log", logMaskService);
+    setInterruptVector(KERNEL_INTERRUPT, kernelInterruptHandler);
+    /* a far pointer for CALL FAR, not an interrupt handler */
+    setInterruptVector(SERVICE_ENTRY_VECTOR, (void interrupt (*)())farServiceEntry);
+    setInterruptVector(DOS_INTERRUPT, DOSInterruptHandler);
+    setInterruptVector(PROGRAM_TERMINATE_INTERRUPT, programTerminateHandler);
 }
\ No newline at end of file
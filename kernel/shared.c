@@ -0,0 +1,97 @@
+/************************************************************************
+* Copyright (C) 2020 by Ahmad Dajani                                    *
+*                                                                       *
+* This file is part of NOS.                                             *
+*                                                                       *
+* NOS is free software: you can redistribute it and/or modify it        *
+* under the terms of the GNU Lesser General Public License as published *
+* by the Free Software Foundation, either version 3 of the License, or  *
+* (at your option) any later version.                                   *
+*                                                                       *
+* NOS is distributed in the hope that it will be useful,                *
+* but WITHOUT ANY WARRANTY* without even the implied warranty of        *
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+* GNU Lesser General Public License for more details.                   *
+*                                                                       *
+* You should have received a copy of the GNU Lesser General Public      *
+* License along with NOS.  If not, see <http://www.gnu.org/licenses/>.  *
+************************************************************************/
+
+/*@file shared.c
+* @author Ahmad Dajani <eng.adajani@gmail.com>
+* @date 19 Oct 2026
+* @brief Shared code segments source file
+* @note The code lives in the kernel heap, not in a process arena, so it
+*       outlives the process that loaded it while other instances run.
+*/
+
+#include <kernel/shared.h>
+#include <kernel/memory.h> /* kmalloc_align, kfree */
+#include <conio.h> /* printFormat */
+#include <string.h> /* NULL, FP_SEG */
+#include <kernel/log.h> /* logTrace */
+
+static struct SharedCode sharedCodes[SHARED_CODE_ENTRIES];
+static unsigned int sharedCodeHits = 0; /* instances that found their code loaded */
+
+struct SharedCode *findSharedCode(struct ImageCacheKey *key) {
+    register unsigned int index;
+    for(index = 0; index < SHARED_CODE_ENTRIES; index++) {
+        if(sharedCodes[index].users && isImageCacheKeyEqual(&sharedCodes[index].key, key)) {
+            sharedCodes[index].users++;
+            sharedCodeHits++;
+            logTrace(LOG_EXEC, ("shared: %s @ %x, %d users\n", key->path,
+                                FP_SEG(sharedCodes[index].block), sharedCodes[index].users));
+            return &sharedCodes[index];
+        }
+    }
+    return NULL;
+}
+
+struct SharedCode *createSharedCode(struct ImageCacheKey *key, unsigned int paragraphs) {
+    /* the caller loads and relocates the code, @return NULL to load it privately */
+    register unsigned int index;
+    for(index = 0; index < SHARED_CODE_ENTRIES; index++) {
+        if(sharedCodes[index].users == 0) {
+            sharedCodes[index].block = kmalloc_align((unsigned long)paragraphs << 4);
+            if(!sharedCodes[index].block) {
+                return NULL;
+            }
+            sharedCodes[index].key = *key;
+            sharedCodes[index].paragraphs = paragraphs;
+            sharedCodes[index].users = 1;
+            logTrace(LOG_EXEC, ("shared: new %s @ %x, %x paragraphs\n", key->path,
+                                FP_SEG(sharedCodes[index].block), paragraphs));
+            return &sharedCodes[index];
+        }
+    }
+    return NULL;
+}
+
+void releaseSharedCode(struct SharedCode *sharedCode) {
+    if(!sharedCode || sharedCode->users == 0) {
+        return;
+    }
+    sharedCode->users--;
+    if(sharedCode->users == 0) {
+        logTrace(LOG_EXEC, ("shared: free %s\n", sharedCode->key.path));
+        kfree(sharedCode->block);
+        sharedCode->block = NULL;
+    }
+}
+
+unsigned int getSharedCodeHits(void) {
+    return sharedCodeHits;
+}
+
+void dumpSharedCode(enum PRINT_STREAM stream) {
+    register unsigned int index;
+    printFormat(stream, "Shared code: %d hits\n", sharedCodeHits);
+    for(index = 0; index < SHARED_CODE_ENTRIES; index++) {
+        if(sharedCodes[index].users) {
+            printFormat(stream, "\t%s @ %x, %x paragraphs, %d users\n", sharedCodes[index].key.path,
+                        FP_SEG(sharedCodes[index].block), sharedCodes[index].paragraphs,
+                        sharedCodes[index].users);
+        }
+    }
+}
\ No newline at end of file
@@ -0,0 +1,158 @@
+/************************************************************************
+* Copyright (C) 2020 by Ahmad Dajani                                    *
+*                                                                       *
+* This file is part of NOS.                                             *
+*                                                                       *
+* NOS is free software: you can redistribute it and/or modify it        *
+* under the terms of the GNU Lesser General Public License as published *
+* by the Free Software Foundation, either version 3 of the License, or  *
+* (at your option) any later version.                                   *
+*                                                                       *
+* NOS is distributed in the hope that it will be useful,                *
+* but WITHOUT ANY WARRANTY* without even the implied warranty of        *
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+* GNU Lesser General Public License for more details.                   *
+*                                                                       *
+* You should have received a copy of the GNU Lesser General Public      *
+* License along with NOS.  If not, see <http://www.gnu.org/licenses/>.  *
+************************************************************************/
+
+/*@file swap.c
+* @author Ahmad Dajani <eng.adajani@gmail.com>
+* @date 19 Oct 2026
+* @brief Process swapping to extended memory source file
+* @note Every region of the process arena (image, data, stack and API_MALLOC
+*       blocks) is copied out and freed. Running programs keep segment values
+*       in registers, on their stacks and in far pointers that no fixup table
+*       describes, so the regions come back at their own addresses only, a
+*       process stays swapped out while another block uses its memory.
+*/
+
+#include <kernel/swap.h>
+#include <kernel/process.h> /* Process, getCurrentProcess */
+#include <kernel/memory.h> /* kmalloc, kmalloc_at, kfree, getAllocationSize */
+#include <kernel/extmem.h> /* extendedMemoryAllocate, copyToExtendedMemory */
+#include <kernel/disk.h> /* SUCCESS, FAILURE */
+#include <conio.h> /* printFormat */
+#include <string.h> /* NULL, FP_SEG */
+#include <kernel/log.h> /* logInfo, logWarning, logTrace */
+
+static unsigned int swapOuts = 0;
+static unsigned int swapIns = 0;
+static unsigned int swapInsDeferred = 0;
+static unsigned long bytesSwapped = 0; /* in extended memory now */
+
+static void freeStorage(struct SwapImage far *swapImage, unsigned int count) {
+    register unsigned int index;
+    for(index = 0; index < count; index++) {
+        extendedMemoryFree(swapImage->regions[index].storage);
+    }
+}
+
+int swapOutProcess(struct Process far *process) {
+    struct SwapImage far *swapImage;
+    struct SwappedRegion far *swapped;
+    struct ArenaRegion far *region;
+    unsigned int index = 0;
+
+    if(!process || process->swapImage || process == getCurrentProcess() || process->arena.regionsCount == 0) {
+        return FAILURE;
+    }
+    /* one entry per arena region, the head, the image and every pheap chunk */
+    swapImage = (struct SwapImage far *)kmalloc(sizeof(struct SwapImage) +
+                (unsigned long)(process->arena.regionsCount - 1) * sizeof(struct SwappedRegion));
+    if(!swapImage) {
+        logWarning(LOG_SCHED, ("swap: process %d skipped, no memory for %d regions\n", process->processId,
+                               process->arena.regionsCount));
+        return FAILURE;
+    }
+
+    /* copy everything first, nothing is freed if extended memory runs out */
+    swapImage->bytes = 0;
+    for(region = process->arena.regions; region; region = region->next, index++) {
+        swapped = &swapImage->regions[index];
+        swapped->address = region;
+        swapped->size = getAllocationSize(region);
+        swapped->storage = extendedMemoryAllocate(swapped->size);
+        if(!swapped->storage || copyToExtendedMemory(swapped->storage, region, swapped->size) != SUCCESS) {
+            if(swapped->storage) {
+                index++;
+            }
+            freeStorage(swapImage, index);
+            kfree(swapImage);
+            logWarning(LOG_SCHED, ("swap: process %d skipped, extended memory is full\n", process->processId));
+            return FAILURE;
+        }
+        swapImage->bytes += swapped->size;
+    }
+    swapImage->regionsCount = index;
+
+    for(index = 0; index < swapImage->regionsCount; index++) {
+        kfree(swapImage->regions[index].address);
+    }
+    process->swapImage = swapImage;
+    swapOuts++;
+    bytesSwapped += swapImage->bytes;
+
+    logInfo(LOG_SCHED, ("swap: out process %d, %d regions, %x paragraphs\n", process->processId,
+                        swapImage->regionsCount, (unsigned int)(swapImage->bytes >> 4)));
+    return SUCCESS;
+}
+
+int swapInProcess(struct Process far *process) {
+    struct SwapImage far *swapImage = process->swapImage;
+    register unsigned int index;
+    unsigned int reclaimed;
+
+    if(!swapImage) {
+        return SUCCESS;
+    }
+
+    for(reclaimed = 0; reclaimed < swapImage->regionsCount; reclaimed++) {
+        if(!kmalloc_at(swapImage->regions[reclaimed].address, swapImage->regions[reclaimed].size)) {
+            for(index = 0; index < reclaimed; index++) {
+                kfree(swapImage->regions[index].address);
+            }
+            swapInsDeferred++;
+            logTrace(LOG_SCHED, ("swap: process %d, region @ %x:0 is in use\n", process->processId,
+                                 FP_SEG(swapImage->regions[reclaimed].address)));
+            return FAILURE;
+        }
+    }
+
+    for(index = 0; index < swapImage->regionsCount; index++) {
+        if(copyFromExtendedMemory(swapImage->regions[index].address, swapImage->regions[index].storage,
+                                  swapImage->regions[index].size) != SUCCESS) {
+            for(index = 0; index < swapImage->regionsCount; index++) {
+                kfree(swapImage->regions[index].address);
+            }
+            return FAILURE;
+        }
+    }
+
+    logInfo(LOG_SCHED, ("swap: in process %d\n", process->processId));
+    discardSwapImage(process);
+    swapIns++;
+    return SUCCESS;
+}
+
+void discardSwapImage(struct Process far *process) {
+    /* the arena regions are not touched, they are resident or freed */
+    struct SwapImage far *swapImage = process->swapImage;
+    if(!swapImage) {
+        return;
+    }
+    freeStorage(swapImage, swapImage->regionsCount);
+    bytesSwapped -= swapImage->bytes;
+    kfree(swapImage);
+    process->swapImage = NULL;
+}
+
+unsigned int getSwapIns(void) {
+    return swapIns;
+}
+
+void dumpSwapStatistics(enum PRINT_STREAM stream) {
+    printFormat(stream, "Swap: %d out, %d in, %d deferred, %x paragraphs swapped\n",
+                swapOuts, swapIns, swapInsDeferred, (unsigned int)(bytesSwapped >> 4));
+}
\ No newline at end of file
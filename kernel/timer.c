@@ -0,0 +1,112 @@
+/************************************************************************
+* Copyright (C) 2020 by Ahmad Dajani                                    *
+*                                                                       *
+* This file is part of NOS.                                             *
+*                                                                       *
+* NOS is free software: you can redistribute it and/or modify it        *
+* under the terms of the GNU Lesser General Public License as published *
+* by the Free Software Foundation, either version 3 of the License, or  *
+* (at your option) any later version.                                   *
+*                                                                       *
+* NOS is distributed in the hope that it will be useful,                *
+* but WITHOUT ANY WARRANTY* without even the implied warranty of        *
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+* GNU Lesser General Public License for more details.                   *
+*                                                                       *
+* You should have received a copy of the GNU Lesser General Public      *
+* License along with NOS.  If not, see <http://www.gnu.org/licenses/>.  *
+************************************************************************/
+
+/*@file timer.c
+* @author Ahmad Dajani <eng.adajani@gmail.com>
+* @date 19 Oct 2026
+* @brief Kernel programmable interval timer source file
+* @note The PIT runs faster than the BIOS 18.2Hz, the BIOS handler is still
+*       called at its own rate to keep the time of day and the floppy motor.
+*/
+
+#include <kernel/timer.h>
+#include <kernel/sched.h> /* schedulerTick */
+#include <conio.h> /* printFormat, inPortByte, outPortByte, drainLogger */
+#include <vector.h> /* setInterruptVector, getInterruptVector */
+#include <string.h> /* NULL */
+#include <kernel/log.h> /* logInfo */
+
+static void interrupt (*biosTimerHandler)(void) = NULL;
+static unsigned long timerTicks = 0;
+static unsigned long biosTickCounter = 0;
+static unsigned int timerDivisor = 0; /* 0 is 65536 (BIOS rate) */
+
+void initializeTimer(void) {
+    biosTimerHandler = getInterruptVector(TIMER_INTERRUPT);
+    setInterruptVector(TIMER_INTERRUPT, timerInterruptHandler);
+    setTimerFrequency(TIMER_FREQUENCY);
+}
+
+void setTimerFrequency(unsigned int hertz) {
+    if(hertz < TIMER_MINIMUM_FREQUENCY) {
+        hertz = TIMER_MINIMUM_FREQUENCY;
+    }
+
+    asm {
+        pushf
+        cli
+    }
+    timerDivisor = (unsigned int)(PIT_FREQUENCY / hertz);
+    outPortByte(PIT_COMMAND_PORT, PIT_CHANNEL0_RATE);
+    outPortByte(PIT_CHANNEL0_PORT, timerDivisor & 0xff);
+    outPortByte(PIT_CHANNEL0_PORT, timerDivisor >> 8);
+    asm popf
+
+    logInfo(LOG_SCHED, ("timer: %d Hz, divisor=%x\n", hertz, timerDivisor));
+}
+
+unsigned int getTimerDivisor(void) {
+    return timerDivisor;
+}
+
+unsigned long getTimerTicks(void) {
+    unsigned long ticks;
+    asm {
+        pushf
+        cli
+    }
+    ticks = timerTicks;
+    asm popf
+    return ticks;
+}
+
+unsigned int readTimerCounter(void) {
+    /* counts down from the divisor by one PIT clock (0.838us) */
+    unsigned char low;
+    unsigned char high;
+    asm {
+        pushf
+        cli
+    }
+    outPortByte(PIT_COMMAND_PORT, PIT_CHANNEL0_LATCH);
+    low = inPortByte(PIT_CHANNEL0_PORT);
+    high = inPortByte(PIT_CHANNEL0_PORT);
+    asm popf
+    return (high << 8) | low;
+}
+
+#pragma argsused
+static void interrupt timerInterruptHandler(unsigned int BP, unsigned int DI, unsigned int SI, unsigned int DS,
+                                            unsigned int ES, unsigned int DX, unsigned int CX, unsigned int BX,
+                                            unsigned int AX, unsigned int IP, unsigned int CS, unsigned int FLAGS) {
+    /* the interrupt prologue saved all registers with DS/ES on the
+       interrupted stack, the scheduler may switch away from here */
+    timerTicks++;
+    biosTickCounter += timerDivisor ? timerDivisor : BIOS_TICK_PERIOD;
+    if(biosTickCounter >= BIOS_TICK_PERIOD) {
+        biosTickCounter -= BIOS_TICK_PERIOD;
+        (*biosTimerHandler)(); /* sends the end of interrupt */
+    }
+    else {
+        outPortByte(PIC_MASTER_PORT, PIC_END_OF_INTERRUPT);
+    }
+
+    (void)drainLogger(LOGGER_DRAIN_PER_TICK); /* bounded, interrupts are off */
+    schedulerTick(CS);
+}
\ No newline at end of file
@@ -26,9 +26,31 @@
 #include <bios.h>
 #include <stdarg.h>
 #include <conio.h>
+#include <string.h> /* MK_FP, getStringLength, movedata */
 
 static unsigned char consoleTextColor = 7;
 static unsigned char consoleActivePage = 0;
+/* the cursor is kept here, the CRTC is updated by flushConsole */
+static unsigned char cursorRow = 0;
+static unsigned char cursorColumn = 0;
+static unsigned char isCursorMoved = 0;
+/* LOGGER output waits in a ring until drainLogger, the port is written
+   directly before enableLoggerBuffer */
+static unsigned char loggerBuffer[LOGGER_BUFFER_SIZE];
+static unsigned int loggerHead = 0; /* next write */
+static unsigned int loggerTail = 0; /* next drain */
+static unsigned char isLoggerBuffered = 0;
+static unsigned long loggerDroppedBytes = 0;
+static unsigned long loggerDroppedWrites = 0;
+
+void initializeConsole(void) {
+    /* continue after the BIOS and boot messages */
+    _AH = 3;
+    _BH = consoleActivePage;
+    CALL_VIDEO_BIOS();
+    cursorRow = _DH;
+    cursorColumn = _DL;
+}
 
 void setTextcolor(unsigned char newcolor) {
     //color attribute background | forground
@@ -39,67 +61,312 @@ void setActivePage(unsigned char page) {
     consoleActivePage = page;
 }
 
+void flushConsole(void) {
+    /* hardware cursor and the BIOS copy for INT 10h AH=03h */
+    unsigned int position;
+    if(!isCursorMoved) {
+        return;
+    }
+    position = consoleActivePage * (VIDEO_PAGE_SIZE >> 1) + cursorRow * SCREEN_WIDTH + cursorColumn;
+    outPortByte(CRTC_INDEX_PORT, CRTC_CURSOR_HIGH);
+    outPortByte(CRTC_DATA_PORT, position >> 8);
+    outPortByte(CRTC_INDEX_PORT, CRTC_CURSOR_LOW);
+    outPortByte(CRTC_DATA_PORT, position & 0xff);
+    *(unsigned int far *)MK_FP(BIOS_DATA_SEGMENT, BIOS_CURSOR_POSITION + (consoleActivePage << 1)) =
+        (cursorRow << 8) | cursorColumn;
+    isCursorMoved = 0;
+}
+
 void setCursorPosition(unsigned char row, unsigned char column) {
-    _AH = 2;
-    _BH = consoleActivePage;
-    _DH = row;
-    _DL = column;
-    CALL_VIDEO_BIOS();
+    cursorRow = row;
+    cursorColumn = column;
+    isCursorMoved = 1;
+    flushConsole();
 }
 
 unsigned char getCursorPosition(unsigned char type) {
-    _AH = 3;
-    _BH = consoleActivePage;
-    CALL_VIDEO_BIOS();
     if(type == ROW) {
-        return _DH;
+        return cursorRow;
+    }
+    return cursorColumn;
+}
+
+static void fillVideo(unsigned int cellOffset, unsigned int cells) {
+    /* spaces with the text color */
+    unsigned int blank = ((unsigned int)consoleTextColor << 8) | ' ';
+    asm {
+        push es
+        push di
+        mov ax, VIDEO_SEGMENT
+        mov es, ax
+        mov di, cellOffset
+        mov ax, blank
+        mov cx, cells
+        cld
+        rep stosw
+        pop di
+        pop es
+    }
+}
+
+static void scrollConsole(void) {
+    /* one block move of the rows below the first, then a blank last row */
+    unsigned int pageOffset = consoleActivePage * VIDEO_PAGE_SIZE;
+    asm {
+        push ds
+        push es
+        push si
+        push di
+        mov ax, VIDEO_SEGMENT
+        mov es, ax
+        mov di, pageOffset
+        mov si, di
+        add si, SCREEN_WIDTH * 2
+        mov cx, (SCREEN_HEIGHT - 1) * SCREEN_WIDTH
+        mov ds, ax
+        cld
+        rep movsw
+        pop di
+        pop si
+        pop es
+        pop ds
+    }
+    fillVideo(pageOffset + (SCREEN_HEIGHT - 1) * SCREEN_WIDTH * 2, SCREEN_WIDTH);
+}
+
+static void startNewLine(void) {
+    cursorColumn = 0;
+    if(++cursorRow == SCREEN_HEIGHT) {
+        scrollConsole();
+        cursorRow = SCREEN_HEIGHT - 1;
+    }
+}
+
+static void writeCells(char far *buffer, unsigned int cells) {
+    /* the cells fit in the cursor row */
+    unsigned int cellOffset = consoleActivePage * VIDEO_PAGE_SIZE + ((cursorRow * SCREEN_WIDTH + cursorColumn) << 1);
+    unsigned char color = consoleTextColor;
+    asm {
+        push ds
+        push es
+        push si
+        push di
+        mov ax, VIDEO_SEGMENT
+        mov es, ax
+        mov di, cellOffset
+        mov cx, cells
+        mov ah, color
+        lds si, buffer
+        cld
+    }
+    copyCell:
+    asm {
+        lodsb
+        stosw
+        loop copyCell
+        pop di
+        pop si
+        pop es
+        pop ds
+    }
+    cursorColumn += cells;
+    if(cursorColumn == SCREEN_WIDTH) {
+        startNewLine();
     }
-    return _DL;
 }
 
 void clearScreen(void) {
-    _AX = 0x0600;
-    _BH = consoleTextColor;
-    _CX = 0x0000; /*ch=row of upper left corner */
-                  /*cl=column of upper left corner */
-    _DX = ((SCREEN_HEIGHT - 1) << 8) | (SCREEN_WIDTH - 1);
-    CALL_VIDEO_BIOS();
+    fillVideo(consoleActivePage * VIDEO_PAGE_SIZE, SCREEN_HEIGHT * SCREEN_WIDTH);
     setCursorPosition(0, 0);
 }
 
-/* @note: Console tab is treated as space! */
+static void outputLogger(char far *buffer, unsigned int bufferLength) {
+    asm {
+        push ds
+        push si
+        mov dx, LOGGER_PORT
+        mov cx, bufferLength
+        lds si, buffer
+        cld
+        rep outsb
+        pop si
+        pop ds
+    }
+}
+
+static void writeLogger(char far *buffer, unsigned int bufferLength) {
+    /* what doesn't fit is dropped and counted, the writer never waits */
+    unsigned int space;
+    unsigned int chunk;
+
+    if(!isLoggerBuffered) {
+        outputLogger(buffer, bufferLength);
+        return;
+    }
+    asm {
+        pushf
+        cli
+    }
+    space = (loggerTail - loggerHead - 1) & (LOGGER_BUFFER_SIZE - 1);
+    if(bufferLength > space) {
+        loggerDroppedBytes += bufferLength - space;
+        loggerDroppedWrites++;
+        bufferLength = space;
+    }
+    while(bufferLength) {
+        chunk = LOGGER_BUFFER_SIZE - loggerHead;
+        if(chunk > bufferLength) {
+            chunk = bufferLength;
+        }
+        movedata(FP_SEG(buffer), FP_OFF(buffer), _DS, (unsigned int)&loggerBuffer[loggerHead], chunk);
+        loggerHead = (loggerHead + chunk) & (LOGGER_BUFFER_SIZE - 1);
+        buffer += chunk;
+        bufferLength -= chunk;
+    }
+    asm popf
+}
+
+void enableLoggerBuffer(void) {
+    isLoggerBuffered = 1;
+}
+
+unsigned int drainLogger(unsigned int maximumBytes) {
+    /* from the timer tick and the idle task
+       @return the bytes written to the port */
+    unsigned int drained = 0;
+    unsigned int chunk;
+
+    asm {
+        pushf
+        cli
+    }
+    while(drained < maximumBytes && loggerTail != loggerHead) {
+        chunk = (loggerHead > loggerTail ? loggerHead : LOGGER_BUFFER_SIZE) - loggerTail;
+        if(chunk > maximumBytes - drained) {
+            chunk = maximumBytes - drained;
+        }
+        outputLogger((char far *)&loggerBuffer[loggerTail], chunk);
+        loggerTail = (loggerTail + chunk) & (LOGGER_BUFFER_SIZE - 1);
+        drained += chunk;
+    }
+    asm popf
+    return drained;
+}
+
+void flushLogger(void) {
+    (void)drainLogger(LOGGER_BUFFER_SIZE);
+}
+
+void dumpLoggerStatistics(enum PRINT_STREAM stream) {
+    printFormat(stream, "Logger: %d of %d bytes pending, dropped %lu bytes in %lu writes\n",
+                (loggerHead - loggerTail) & (LOGGER_BUFFER_SIZE - 1), LOGGER_BUFFER_SIZE,
+                loggerDroppedBytes, loggerDroppedWrites);
+}
+
+/* @note: Console tab is treated as space! The console cells are written
+          directly, call flushConsole to move the hardware cursor */
 void printCharacter(enum PRINT_STREAM stream, unsigned char character) {
     switch(stream) {
         case STDOUT:
-            _AH = 0xe;
-            _AL = character;
-            _BH = consoleActivePage;
-            CALL_VIDEO_BIOS();
-            if(character == CONSOLE_LINE_FEED) {
-                /* convert \n into \n\r */
-                _AL = CONSOLE_CARRIAGE_RETURN;
-                CALL_VIDEO_BIOS();
+            switch(character) {
+                case CONSOLE_LINE_FEED:
+                    /* convert \n into \n\r */
+                    startNewLine();
+                    break;
+
+                case CONSOLE_CARRIAGE_RETURN:
+                    cursorColumn = 0;
+                    break;
+
+                case CONSOLE_BACKSPACE:
+                    if(cursorColumn) {
+                        cursorColumn--;
+                    }
+                    else if(cursorRow) {
+                        cursorRow--;
+                        cursorColumn = SCREEN_WIDTH - 1;
+                    }
+                    break;
+
+                case CONSOLE_BELL:
+                    break;
+
+                default:
+                    *(unsigned int far *)MK_FP(VIDEO_SEGMENT, consoleActivePage * VIDEO_PAGE_SIZE +
+                                               ((cursorRow * SCREEN_WIDTH + cursorColumn) << 1)) =
+                        ((unsigned int)consoleTextColor << 8) | character;
+                    if(++cursorColumn == SCREEN_WIDTH) {
+                        startNewLine();
+                    }
+                    break;
             }
+            isCursorMoved = 1;
             break;
 
         case LOGGER:
-            outPortByte(0xe9, character);
+            writeLogger((char far *)MK_FP(_SS, (unsigned int)&character), 1);
             break;
     }
 }
 
-void printString(enum PRINT_STREAM stream, char *string) {
-    while(*string) {
-        printCharacter(stream, *string++);
+/* the printable runs are copied to the video memory a row part at a
+   time, the logger gets the whole buffer with rep outsb */
+static void putStream(enum PRINT_STREAM stream, char far *buffer, unsigned int bufferLength) {
+    unsigned int run;
+    unsigned int columns;
+
+    switch(stream) {
+        case STDOUT:
+            while(bufferLength) {
+                columns = SCREEN_WIDTH - cursorColumn;
+                for(run = 0; run < bufferLength && run < columns && (unsigned char)buffer[run] >= ' '; run++);
+                if(run) {
+                    writeCells(buffer, run);
+                    isCursorMoved = 1;
+                }
+                else {
+                    printCharacter(STDOUT, *buffer);
+                    run = 1;
+                }
+                buffer += run;
+                bufferLength -= run;
+            }
+            break;
+
+        case LOGGER:
+            writeLogger(buffer, bufferLength);
+            break;
     }
 }
 
+static void putString(enum PRINT_STREAM stream, char *string) {
+    putStream(stream, string, getStringLength(string));
+}
+
+void writeStream(enum PRINT_STREAM stream, char far *buffer, unsigned int bufferLength) {
+    putStream(stream, buffer, bufferLength);
+    flushConsole();
+}
+
+void printString(enum PRINT_STREAM stream, char *string) {
+    putString(stream, string);
+    flushConsole();
+}
+
 unsigned char readCharacter(void) {
+    flushConsole();
     _AH = 0;
     CALL_KEYBOARD_BIOS();
     return _AL;
 }
 
+unsigned char isKeyAvailable(void) {
+    /* ZF is cleared when a key is waiting, the key stays in the buffer */
+    _AH = 1;
+    CALL_KEYBOARD_BIOS();
+    return (_FLAGS & 0x40) == 0;
+}
+
 int convertStringToInteger(char *string) {
     int result = 0;
     int sign = 1;
@@ -133,7 +400,7 @@ unsigned int convertHexStringToInteger(unsigned char *hexNumber) {
 
 char *convertIntegerToString(unsigned int num, int base) {
     /* e.g itoa */
-    #define MAX_CONVERT_BUFFER 5 /* max integer is 65535, ffff */
+    #define MAX_CONVERT_BUFFER 6 /* max integer is 65535, ffff, 177777 in octal */
     static char lookup[] = {"0123456789abcdef"};
     static char buffer[MAX_CONVERT_BUFFER + 1] = {NULL}; /* plus null*/
     char *ptr;
@@ -150,49 +417,13 @@ char *convertIntegerToString(unsigned int num, int base) {
 }
 
 void printFormat(enum PRINT_STREAM stream, char* format, ...) {
-    register char *character;
-    register char *string;
-    register int integer;
-
-    va_list arg;
-    va_start(arg, format);
-
-    for(character = format; *character != NULL; character++) {
-        if(*character != '%') {
-            printCharacter(stream, *character);
-        }
-        else {
-            character++; /* skip % */
-            switch(*character) {
-                case 'c' :  integer = va_arg(arg, char);
-                            printCharacter(stream, (char)integer);
-                            break;
-
-                case 's':   string = va_arg(arg, char *);
-                            printString(stream, string);
-                            break;
-
-                case 'd' :  integer = va_arg(arg, int);
-                            if(integer < 0) {
-                                integer = -integer;
-                                printCharacter(stream, '-');
-                            }
-                            printString(stream, convertIntegerToString(integer, 10));
-                            break;
-
-                case 'o':   integer = va_arg(arg, unsigned int);
-                            printString(stream, convertIntegerToString(integer, 8));
-                            break;
-
-
-                case 'x':   integer = va_arg(arg, unsigned int);
-                            printString(stream, convertIntegerToString(integer, 16));
-                            break;
-            }
-        }
-    }
-
-    va_end(arg);
+    /* formatted on the stack, written in FORMAT_BUFFER_SIZE runs */
+    char buffer[FORMAT_BUFFER_SIZE];
+    va_list arguments;
+    va_start(arguments, format);
+    (void)formatOutput(stream, (char far *)MK_FP(_SS, (unsigned int)buffer), FORMAT_BUFFER_SIZE, format, arguments);
+    va_end(arguments);
+    flushConsole();
 }
 
 unsigned char *readString(unsigned char *string) {
@@ -200,8 +431,6 @@ unsigned char *readString(unsigned char *string) {
     unsigned int maximumLength;
     unsigned char *stringPointer;
     unsigned char character=0;
-    int currentColumn;
-    int currentRow;
     if (!string) {
         return NULL;
     }
@@ -221,18 +450,8 @@ unsigned char *readString(unsigned char *string) {
                 continue; /* nothing to erase */
             }
 
-            currentColumn = getCursorPosition(COLUMN);
-            currentRow = getCursorPosition(ROW);
-
-            currentColumn--;
-            if(currentColumn < 0) {
-                currentColumn = SCREEN_WIDTH - 1;
-                currentRow--;
-            }
-
-            setCursorPosition(currentRow, currentColumn);
-            printCharacter(STDOUT, ' ');
-            setCursorPosition(currentRow, currentColumn);
+            /* at column 0 the backspace goes to the end of the previous row */
+            printString(STDOUT, "\b \b");
 
             actualLength--;
             stringPointer[actualLength] = NULL;
@@ -0,0 +1,223 @@
+/************************************************************************
+* Copyright (C) 2020 by Ahmad Dajani                                    *
+*                                                                       *
+* This file is part of NOS.                                             *
+*                                                                       *
+* NOS is free software: you can redistribute it and/or modify it        *
+* under the terms of the GNU Lesser General Public License as published *
+* by the Free Software Foundation, either version 3 of the License, or  *
+* (at your option) any later version.                                   *
+*                                                                       *
+* NOS is distributed in the hope that it will be useful,                *
+* but WITHOUT ANY WARRANTY* without even the implied warranty of        *
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+* GNU Lesser General Public License for more details.                   *
+*                                                                       *
+* You should have received a copy of the GNU Lesser General Public      *
+* License along with NOS.  If not, see <http://www.gnu.org/licenses/>.  *
+************************************************************************/
+
+/*@file format.c
+* @author Ahmad Dajani <eng.adajani@gmail.com>
+* @date 19 Oct 2026
+* @brief printf style formatting source file
+* @note Built on the host as is by tools/formattest
+*/
+
+#include <stdarg.h>
+#include <conio.h> /* writeStream, FORMAT_DIGITS, FORMAT_NO_STREAM */
+#include <string.h> /* MK_FP, getStringLength */
+
+#ifndef FORMAT_STACK_POINTER
+    /* far pointer to a local, SS is not DS in the interrupt handlers */
+    #define FORMAT_STACK_POINTER(local) ((char far *)MK_FP(_SS, (unsigned int)(local)))
+#endif
+
+/* the output goes to the buffer, and with a stream to writeStream every
+   time the buffer is full */
+#define FORMAT_PUT(character) do { \
+        if(used == limit && stream != FORMAT_NO_STREAM) { \
+            writeStream((enum PRINT_STREAM)stream, buffer, used); \
+            used = 0; \
+        } \
+        if(used < limit) { \
+            buffer[used++] = (character); \
+        } \
+        length++; \
+    } while(0)
+
+unsigned int formatOutput(int stream, char far *buffer, unsigned int bufferSize,
+                                 char *format, va_list arguments) {
+    /* %c %s %d %u %o %x %X and %%, l for long, the - and 0 flags and a width
+       @return the length of the whole output
+       @note the stack is not DS in the interrupt handlers, the digits are
+             reached with a far pointer */
+    static char lowerDigits[] = "0123456789abcdef";
+    static char upperDigits[] = "0123456789ABCDEF";
+    char digits[FORMAT_DIGITS];
+    char far *digitsPointer = FORMAT_STACK_POINTER(digits);
+    char far *text;
+    char *lookup;
+    unsigned int limit = stream != FORMAT_NO_STREAM ? bufferSize : (bufferSize ? bufferSize - 1 : 0);
+    unsigned int used = 0;
+    unsigned int length = 0;
+    unsigned int width;
+    unsigned int count;
+    unsigned int base;
+    unsigned int shift;
+    unsigned int smallValue;
+    unsigned long value;
+    char sign;
+    char isLeft;
+    char isZero;
+    char isLong;
+
+    for(; *format != NULL; format++) {
+        if(*format != '%') {
+            FORMAT_PUT(*format);
+            continue;
+        }
+        format++; /* skip % */
+
+        isLeft = 0;
+        isZero = 0;
+        for(;; format++) {
+            if(*format == '-') {
+                isLeft = 1;
+            }
+            else if(*format == '0') {
+                isZero = 1;
+            }
+            else {
+                break;
+            }
+        }
+        for(width = 0; *format >= '0' && *format <= '9'; format++) {
+            width = width * 10 + (*format - '0');
+        }
+        isLong = *format == 'l';
+        if(isLong) {
+            format++;
+        }
+
+        sign = 0;
+        switch(*format) {
+            case 'c':
+                digitsPointer[0] = (char)va_arg(arguments, int);
+                text = digitsPointer;
+                count = 1;
+                break;
+
+            case 's':
+                text = (char far *)va_arg(arguments, char *);
+                count = getStringLength(text);
+                break;
+
+            case 'd':
+            case 'u':
+            case 'o':
+            case 'x':
+            case 'X':
+                if(isLong) {
+                    value = va_arg(arguments, unsigned long);
+                    if(*format == 'd' && (long)value < 0) {
+                        sign = '-';
+                        value = (unsigned long)-(long)value;
+                    }
+                }
+                else {
+                    value = va_arg(arguments, unsigned int);
+                    if(*format == 'd' && (int)value < 0) {
+                        sign = '-';
+                        value = (unsigned int)-(int)value;
+                    }
+                }
+                lookup = *format == 'X' ? upperDigits : lowerDigits;
+                count = FORMAT_DIGITS;
+                if(*format == 'x' || *format == 'X' || *format == 'o') {
+                    base = *format == 'o' ? 7 : 15; /* mask */
+                    shift = *format == 'o' ? 3 : 4;
+                    do {
+                        digitsPointer[--count] = lookup[(unsigned int)value & base];
+                        value >>= shift;
+                    } while(value);
+                }
+                else {
+                    /* long division only above 16 bits */
+                    while(value > 0xffffUL) {
+                        digitsPointer[--count] = lookup[(unsigned int)(value % 10)];
+                        value /= 10;
+                    }
+                    smallValue = (unsigned int)value;
+                    do {
+                        digitsPointer[--count] = lookup[smallValue % 10];
+                        smallValue /= 10;
+                    } while(smallValue);
+                }
+                text = digitsPointer + count;
+                count = FORMAT_DIGITS - count;
+                break;
+
+            case '\0':
+                format--; /* ends the loop */
+                continue;
+
+            default:
+                /* %% and the unknown conversions are printed as they are */
+                FORMAT_PUT(*format);
+                continue;
+        }
+
+        if(sign) {
+            count++;
+        }
+        if(!isLeft && !isZero) {
+            for(; width > count; width--) {
+                FORMAT_PUT(' ');
+            }
+        }
+        if(sign) {
+            FORMAT_PUT(sign);
+            count--;
+            if(width) {
+                width--;
+            }
+        }
+        if(!isLeft && isZero) {
+            for(; width > count; width--) {
+                FORMAT_PUT('0');
+            }
+        }
+        for(; count; count--) {
+            FORMAT_PUT(*text++);
+            if(width) {
+                width--;
+            }
+        }
+        for(; width; width--) {
+            FORMAT_PUT(' ');
+        }
+    }
+
+    if(stream != FORMAT_NO_STREAM) {
+        writeStream((enum PRINT_STREAM)stream, buffer, used);
+    }
+    else if(bufferSize) {
+        buffer[used] = NULL;
+    }
+    return length;
+}
+
+int formatString(char far *buffer, unsigned int bufferSize, char *format, va_list arguments) {
+    /* as vsnprintf, the output is cut to bufferSize - 1 and NUL ended */
+    return formatOutput(FORMAT_NO_STREAM, buffer, bufferSize, format, arguments);
+}
+
+int printToString(char far *buffer, unsigned int bufferSize, char *format, ...) {
+    int length;
+    va_list arguments;
+    va_start(arguments, format);
+    length = formatOutput(FORMAT_NO_STREAM, buffer, bufferSize, format, arguments);
+    va_end(arguments);
+    return length;
+}
\ No newline at end of file
@@ -60,6 +60,27 @@ void movedata(unsigned SourceSegment, unsigned SourceOffset,
     }
 }
 
+size_t getStringLength(char far *string) {
+    asm {
+        push es
+        push di
+    }
+    _ES = FP_SEG(string);
+    _DI = FP_OFF(string);
+
+    asm {
+        mov cx, 0xffff
+        xor al, al
+        cld
+        repne scasb
+        not cx
+        dec cx
+        pop di
+        pop es
+    }
+    return _CX;
+}
+
 unsigned char convertCharacterToLowerCase(unsigned char character) {
     if( (character >= 'A') && (character <= 'Z')) {
         return character + 32;
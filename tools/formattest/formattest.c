@@ -0,0 +1,199 @@
+/************************************************************************
+* Copyright (C) 2020 by Ahmad Dajani                                    *
+*                                                                       *
+* This file is part of NOS.                                             *
+*                                                                       *
+* NOS is free software: you can redistribute it and/or modify it        *
+* under the terms of the GNU Lesser General Public License as published *
+* by the Free Software Foundation, either version 3 of the License, or  *
+* (at your option) any later version.                                   *
+*                                                                       *
+* NOS is distributed in the hope that it will be useful,                *
+* but WITHOUT ANY WARRANTY* without even the implied warranty of        *
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+* GNU Lesser General Public License for more details.                   *
+*                                                                       *
+* You should have received a copy of the GNU Lesser General Public      *
+* License along with NOS.  If not, see <http://www.gnu.org/licenses/>.  *
+************************************************************************/
+
+/*@file formattest.c
+* @author Ahmad Dajani <eng.adajani@gmail.com>
+* @date 19 Oct 2026
+* @brief Host test of the printf style engine (libc/format.c)
+* @description Formats known cases with printToString and formatOutput and
+*              compares them against the expected strings.
+* @note format.c is built with long as int, so long is 32 bit as on the
+*       16 bit kernel. int is wider on the host, the cases keep int values
+*       within 16 bits.
+*/
+
+#include <stdio.h> /* printf */
+#include <string.h> /* strcmp, strlen, memset */
+#include "host/conio.h" /* printToString, formatOutput, FORMAT_BUFFER_SIZE */
+
+#define TARGET_LONG int /* long on the target */
+#define OUTPUT_SIZE 1024
+#define MAX_WRITES 16
+
+static char output[OUTPUT_SIZE]; /* what writeStream received */
+static unsigned int outputLength = 0;
+static unsigned int writes[MAX_WRITES];
+static unsigned int writesCount = 0;
+static unsigned int failures = 0;
+static unsigned int checks = 0;
+
+unsigned int getStringLength(char *string) {
+    return (unsigned int)strlen(string);
+}
+
+void writeStream(enum PRINT_STREAM stream, char *buffer, unsigned int bufferLength) {
+    (void)stream;
+    if(outputLength + bufferLength < OUTPUT_SIZE) {
+        memcpy(output + outputLength, buffer, bufferLength);
+        outputLength += bufferLength;
+        output[outputLength] = '\0';
+    }
+    if(writesCount < MAX_WRITES) {
+        writes[writesCount] = bufferLength;
+    }
+    writesCount++;
+}
+
+static void check(char *name, char *actual, char *expected) {
+    checks++;
+    if(strcmp(actual, expected) != 0) {
+        printf("FAIL %s: [%s], expected [%s]\n", name, actual, expected);
+        failures++;
+    }
+}
+
+static void checkNumber(char *name, unsigned int actual, unsigned int expected) {
+    checks++;
+    if(actual != expected) {
+        printf("FAIL %s: %u, expected %u\n", name, actual, expected);
+        failures++;
+    }
+}
+
+#define CHECK_FORMAT(expected, ...) do { \
+        char buffer[FORMAT_BUFFER_SIZE]; \
+        (void)printToString(buffer, sizeof(buffer), __VA_ARGS__); \
+        check(#__VA_ARGS__, buffer, expected); \
+    } while(0)
+
+static void testConversions(void) {
+    CHECK_FORMAT("0", "%d", 0);
+    CHECK_FORMAT("-1", "%d", -1);
+    CHECK_FORMAT("32767 -32768", "%d %d", 32767, -32768);
+    CHECK_FORMAT("65535", "%u", 65535);
+    CHECK_FORMAT("beef BEEF", "%x %X", 0xbeef, 0xbeef);
+    CHECK_FORMAT("177777", "%o", 0xffff);
+    CHECK_FORMAT("A", "%c", 'A');
+    CHECK_FORMAT("nos", "%s", "nos");
+    CHECK_FORMAT("", "%s", "");
+    CHECK_FORMAT("100%", "%d%%", 100);
+    CHECK_FORMAT("q", "%q");
+    CHECK_FORMAT("abc", "abc%");
+}
+
+static void testWidthsAndFlags(void) {
+    CHECK_FORMAT("   42", "%5d", 42);
+    CHECK_FORMAT("42   |", "%-5d|", 42);
+    CHECK_FORMAT("00042", "%05d", 42);
+    CHECK_FORMAT("-0042", "%05d", -42);
+    CHECK_FORMAT("  -42", "%5d", -42);
+    CHECK_FORMAT("-42  |", "%-5d|", -42);
+    CHECK_FORMAT("0001f", "%05x", 0x1f);
+    CHECK_FORMAT("  A", "%3c", 'A');
+    CHECK_FORMAT("nos   |", "%-6s|", "nos");
+    CHECK_FORMAT("long", "%2s", "long");
+    CHECK_FORMAT("12345", "%3d", 12345);
+    CHECK_FORMAT("a  b", "%-3cb", 'a');
+}
+
+static void testLongs(void) {
+    CHECK_FORMAT("-70000", "%ld", (TARGET_LONG)-70000);
+    CHECK_FORMAT("-2147483648", "%ld", (TARGET_LONG)0x80000000U);
+    CHECK_FORMAT("2147483647", "%ld", (TARGET_LONG)0x7fffffff);
+    CHECK_FORMAT("ffffffff", "%lx", (TARGET_LONG)-1);
+    CHECK_FORMAT("DEADBEEF", "%lX", (TARGET_LONG)0xdeadbeefU);
+    CHECK_FORMAT("37777777777", "%lo", (TARGET_LONG)-1);
+    CHECK_FORMAT("4000000000", "%lu", (TARGET_LONG)4000000000U);
+    CHECK_FORMAT("00001234", "%08lx", (TARGET_LONG)0x1234);
+    CHECK_FORMAT("  -70000|", "%8ld|", (TARGET_LONG)-70000);
+    CHECK_FORMAT("-0070000", "%08ld", (TARGET_LONG)-70000);
+    CHECK_FORMAT("65536 1", "%lu %d", (TARGET_LONG)65536, 1);
+}
+
+static void testTruncation(void) {
+    char buffer[16];
+
+    memset(buffer, 'x', sizeof(buffer));
+    checkNumber("truncated length", (unsigned int)printToString(buffer, 8, "%s", "abcdefghij"), 10);
+    check("truncated text", buffer, "abcdefg");
+    checkNumber("truncated guard", buffer[8], 'x');
+
+    checkNumber("width truncated length", (unsigned int)printToString(buffer, 4, "%6d", 12), 6);
+    check("width truncated text", buffer, "   ");
+
+    memset(buffer, 'x', sizeof(buffer));
+    checkNumber("size 1 length", (unsigned int)printToString(buffer, 1, "abc"), 3);
+    check("size 1 text", buffer, "");
+
+    memset(buffer, 'x', sizeof(buffer));
+    checkNumber("size 0 length", (unsigned int)printToString(buffer, 0, "abc"), 3);
+    checkNumber("size 0 untouched", buffer[0], 'x');
+
+    checkNumber("exact fit length", (unsigned int)printToString(buffer, 4, "abc"), 3);
+    check("exact fit text", buffer, "abc");
+}
+
+static unsigned int formatToStream(char *buffer, unsigned int bufferSize, char *format, ...) {
+    unsigned int length;
+    va_list arguments;
+
+    outputLength = 0;
+    output[0] = '\0';
+    writesCount = 0;
+    va_start(arguments, format);
+    length = formatOutput(STDOUT, buffer, bufferSize, format, arguments);
+    va_end(arguments);
+    return length;
+}
+
+static void testRefills(void) {
+    char buffer[FORMAT_BUFFER_SIZE];
+    char expected[OUTPUT_SIZE];
+
+    /* the whole buffer is used before every write, the rest at the end */
+    memset(expected, ' ', 299);
+    expected[299] = 'x';
+    expected[300] = '\0';
+    checkNumber("refill length", formatToStream(buffer, FORMAT_BUFFER_SIZE, "%300s", "x"), 300);
+    check("refill text", output, expected);
+    checkNumber("refill writes", writesCount, 3);
+    checkNumber("refill first write", writes[0], FORMAT_BUFFER_SIZE);
+    checkNumber("refill second write", writes[1], FORMAT_BUFFER_SIZE);
+    checkNumber("refill last write", writes[2], 300 - 2 * FORMAT_BUFFER_SIZE);
+
+    checkNumber("exact refill length", formatToStream(buffer, FORMAT_BUFFER_SIZE, "%128s", "x"), 128);
+    checkNumber("exact refill writes", writesCount, 1);
+
+    checkNumber("small refill length", formatToStream(buffer, 4, "hello %s", "world"), 11);
+    check("small refill text", output, "hello world");
+    checkNumber("small refill writes", writesCount, 3);
+
+    checkNumber("number across refill", formatToStream(buffer, 4, "ab%ld", (TARGET_LONG)-123456), 9);
+    check("number across refill text", output, "ab-123456");
+}
+
+int main(void) {
+    testConversions();
+    testWidthsAndFlags();
+    testLongs();
+    testTruncation();
+    testRefills();
+    printf("%u checks, %u failures\n", checks, failures);
+    return failures ? 1 : 0;
+}
\ No newline at end of file
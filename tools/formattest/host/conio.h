@@ -0,0 +1,47 @@
+/************************************************************************
+* Copyright (C) 2020 by Ahmad Dajani                                    *
+*                                                                       *
+* This file is part of NOS.                                             *
+*                                                                       *
+* NOS is free software: you can redistribute it and/or modify it        *
+* under the terms of the GNU Lesser General Public License as published *
+* by the Free Software Foundation, either version 3 of the License, or  *
+* (at your option) any later version.                                   *
+*                                                                       *
+* NOS is distributed in the hope that it will be useful,                *
+* but WITHOUT ANY WARRANTY* without even the implied warranty of        *
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+* GNU Lesser General Public License for more details.                   *
+*                                                                       *
+* You should have received a copy of the GNU Lesser General Public      *
+* License along with NOS.  If not, see <http://www.gnu.org/licenses/>.  *
+************************************************************************/
+
+/*@file conio.h
+* @author Ahmad Dajani <eng.adajani@gmail.com>
+* @date 19 Oct 2026
+* @brief Host replacement of include/conio.h for libc/format.c
+*/
+
+#ifndef __CONIO_H
+    #define __CONIO_H
+    #include <stdarg.h> /* va_list */
+
+    /* the locals are plain pointers on the host */
+    #define FORMAT_STACK_POINTER(local) ((char *)(local))
+
+    #define FORMAT_BUFFER_SIZE 128
+    #define FORMAT_DIGITS 11
+    #define FORMAT_NO_STREAM -1
+
+    enum PRINT_STREAM {
+        STDOUT = 0,
+        LOGGER = 1
+    };
+
+    void writeStream(enum PRINT_STREAM stream, char *buffer, unsigned int bufferLength);
+    unsigned int formatOutput(int stream, char *buffer, unsigned int bufferSize,
+                              char *format, va_list arguments);
+    int formatString(char *buffer, unsigned int bufferSize, char *format, va_list arguments);
+    int printToString(char *buffer, unsigned int bufferSize, char *format, ...);
+#endif
\ No newline at end of file
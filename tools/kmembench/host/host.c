@@ -0,0 +1,81 @@
+/************************************************************************
+* Copyright (C) 2020 by Ahmad Dajani                                    *
+*                                                                       *
+* This file is part of NOS.                                             *
+*                                                                       *
+* NOS is free software: you can redistribute it and/or modify it        *
+* under the terms of the GNU Lesser General Public License as published *
+* by the Free Software Foundation, either version 3 of the License, or  *
+* (at your option) any later version.                                   *
+*                                                                       *
+* NOS is distributed in the hope that it will be useful,                *
+* but WITHOUT ANY WARRANTY* without even the implied warranty of        *
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+* GNU Lesser General Public License for more details.                   *
+*                                                                       *
+* You should have received a copy of the GNU Lesser General Public      *
+* License along with NOS.  If not, see <http://www.gnu.org/licenses/>.  *
+************************************************************************/
+
+/*@file host.c
+* @author Ahmad Dajani <eng.adajani@gmail.com>
+* @date 19 Oct 2026
+* @brief Simulated real mode environment to build kernel/memory.c on the host
+*/
+
+#include <stdio.h> /* vfprintf, stderr */
+#include <stdlib.h> /* calloc, exit */
+#include <stdarg.h> /* va_list */
+#include "host.h"
+#include "conio.h"
+#include <kernel/log.h> /* LOG_LEVELS, LOG_ALL */
+
+unsigned char *simulatedMemory = NULL;
+unsigned int _AX = 0;
+unsigned int _CS = 0;
+int hostVerbose = 0;
+
+void initializeHost(unsigned int kilobytes, unsigned int kernelSegment) {
+    if(!simulatedMemory) {
+        simulatedMemory = (unsigned char *)calloc(SIMULATED_MEMORY_SIZE, 1);
+        if(!simulatedMemory) {
+            fprintf(stderr, "Error: Cannot allocate simulated memory\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+    _AX = kilobytes;
+    _CS = kernelSegment;
+}
+
+void printFormat(enum PRINT_STREAM stream, char *format, ...) {
+    va_list arg;
+    (void)stream;
+    if(!hostVerbose) {
+        return;
+    }
+    va_start(arg, format);
+    vfprintf(stderr, format, arg);
+    va_end(arg);
+}
+
+unsigned char logMask[LOG_LEVELS] = {LOG_ALL, LOG_ALL, LOG_ALL, LOG_ALL};
+
+void logPrint(char *format, ...) {
+    va_list arg;
+    if(!hostVerbose) {
+        return;
+    }
+    va_start(arg, format);
+    vfprintf(stderr, format, arg);
+    va_end(arg);
+}
+
+void outPortByte(unsigned int portNumber, unsigned char value) {
+    (void)portNumber;
+    (void)value;
+}
+
+void outPortWord(unsigned int portNumber, unsigned int value) {
+    (void)portNumber;
+    (void)value;
+}
\ No newline at end of file
@@ -0,0 +1,40 @@
+/************************************************************************
+* Copyright (C) 2020 by Ahmad Dajani                                    *
+*                                                                       *
+* This file is part of NOS.                                             *
+*                                                                       *
+* NOS is free software: you can redistribute it and/or modify it        *
+* under the terms of the GNU Lesser General Public License as published *
+* by the Free Software Foundation, either version 3 of the License, or  *
+* (at your option) any later version.                                   *
+*                                                                       *
+* NOS is distributed in the hope that it will be useful,                *
+* but WITHOUT ANY WARRANTY* without even the implied warranty of        *
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+* GNU Lesser General Public License for more details.                   *
+*                                                                       *
+* You should have received a copy of the GNU Lesser General Public      *
+* License along with NOS.  If not, see <http://www.gnu.org/licenses/>.  *
+************************************************************************/
+
+/*@file string.h
+* @author Ahmad Dajani <eng.adajani@gmail.com>
+* @date 19 Oct 2026
+* @brief Host replacement of include/string.h
+*/
+
+#ifndef __STRING_H
+    #define __STRING_H
+    #include <stddef.h> /* size_t */
+    #include "host.h"
+
+    /* the kernel compares linear addresses against NULL */
+    #undef NULL
+    #define NULL 0
+
+    #define MK_FP(seg, ofs) ((void *)(simulatedMemory + ((unsigned long)(seg) << 4) + (ofs)))
+    #define FP_SEG(fp) ((unsigned int)(((unsigned char *)(fp) - simulatedMemory) >> 4))
+    #define FP_OFF(fp) ((unsigned int)(((unsigned char *)(fp) - simulatedMemory) & 0xf))
+
+    void *memset(void *address, int value, size_t size);
+#endif
\ No newline at end of file
@@ -0,0 +1,447 @@
+/************************************************************************
+* Copyright (C) 2020 by Ahmad Dajani                                    *
+*                                                                       *
+* This file is part of NOS.                                             *
+*                                                                       *
+* NOS is free software: you can redistribute it and/or modify it        *
+* under the terms of the GNU Lesser General Public License as published *
+* by the Free Software Foundation, either version 3 of the License, or  *
+* (at your option) any later version.                                   *
+*                                                                       *
+* NOS is distributed in the hope that it will be useful,                *
+* but WITHOUT ANY WARRANTY* without even the implied warranty of        *
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+* GNU Lesser General Public License for more details.                   *
+*                                                                       *
+* You should have received a copy of the GNU Lesser General Public      *
+* License along with NOS.  If not, see <http://www.gnu.org/licenses/>.  *
+************************************************************************/
+
+/*@file kmembench.c
+* @author Ahmad Dajani <eng.adajani@gmail.com>
+* @date 19 Oct 2026
+* @brief Kernel allocator trace replay benchmark
+* @description Replay kmalloc/kfree traces recorded by the kernel (KMEM_TRACE)
+*              against a host build of kernel/memory.c, and report speed,
+*              footprint and fragmentation.
+* @note MCB headers are bigger on the host (32/64 bit long), so footprints are
+*       slightly pessimistic compared to the 16 bit kernel.
+*/
+
+#include <stdio.h> /* printf, fprintf, fopen, fgets, sscanf */
+#include <stdlib.h> /* malloc, realloc, calloc, free, strtoul, exit */
+#include <time.h> /* clock_gettime */
+#include <kernel/memory.h> /* kmalloc, kmalloc_align, kfree, getHeapStatistics */
+#include "host.h" /* initializeHost */
+
+#define VERSION "0.1"
+#define LINE_SIZE 256
+#define DEFAULT_KILOBYTES 640
+#define DEFAULT_KERNEL_SEGMENT 0x60 /* @see kernel\Makefile */
+#define DEFAULT_HEAP_START 0x4800 /* kernel image + bss + stack */
+#define DEFAULT_REPEAT 100
+#define MAX_CALLERS 64
+
+extern unsigned long startAddress; /* @see kernel\memory.c */
+extern unsigned long initializedAddress;
+
+enum OperationType {
+    OPERATION_MALLOC,
+    OPERATION_FREE
+};
+
+struct Operation {
+    enum OperationType type;
+    unsigned long size;
+    unsigned int isAligned;
+    unsigned long traceAddress; /* linear address in the recorded run */
+    unsigned int caller;
+};
+
+struct Trace {
+    struct Operation *operations;
+    unsigned long count;
+    unsigned long capacity;
+};
+
+/* trace address -> replayed address, open addressing */
+struct AddressMap {
+    unsigned long *keys;
+    void **values;
+    unsigned long capacity;
+};
+
+struct CallerLeak {
+    unsigned int caller;
+    unsigned long blocks;
+    unsigned long bytes;
+};
+
+struct Arguments {
+    unsigned int kilobytes;
+    unsigned int heapStart;
+    unsigned int repeat;
+    char *traceName;
+};
+
+void usage(void) {
+    printf("Kernel allocator trace replay, version %s\n"
+           "(c)2020, By Ahmad Dajani, eng.adajani@gmail.com\n"
+           "Usage: kmembench [-kb kilobytes] [-heap offset] [-repeat count] [-v] traceFile\n"
+           "Where:\n"
+           "    -kb      [optional]  Conventional memory size in KB (default %d).\n"
+           "    -heap    [optional]  Kernel heap start offset in hex (default %x).\n"
+           "    -repeat  [optional]  Timed replays (default %d).\n"
+           "    -v       [optional]  Print kernel LOGGER output.\n"
+           "    traceFile            Bochs log with @kmalloc/@kfree lines (KMEM_TRACE).\n"
+           , VERSION, DEFAULT_KILOBYTES, DEFAULT_HEAP_START, DEFAULT_REPEAT);
+}
+
+static char *findText(char *line, char *text) {
+    char *start;
+    char *current;
+    char *pattern;
+    for(start = line; *start; start++) {
+        for(current = start, pattern = text; *pattern && *current == *pattern; current++, pattern++);
+        if(!*pattern) {
+            return start;
+        }
+    }
+    return NULL;
+}
+
+static int isText(char *left, char *right) {
+    while(*left && *left == *right) {
+        left++;
+        right++;
+    }
+    return *left == *right;
+}
+
+int parseArguments(int argc, char *argv[], struct Arguments *arguments) {
+    int argumentIndex;
+
+    arguments->kilobytes = DEFAULT_KILOBYTES;
+    arguments->heapStart = DEFAULT_HEAP_START;
+    arguments->repeat = DEFAULT_REPEAT;
+    arguments->traceName = NULL;
+
+    for(argumentIndex = 1; argumentIndex < argc; argumentIndex++) {
+        if(isText(argv[argumentIndex], "-kb") && argumentIndex + 1 < argc) {
+            arguments->kilobytes = (unsigned int)strtoul(argv[++argumentIndex], NULL, 10);
+        } else if(isText(argv[argumentIndex], "-heap") && argumentIndex + 1 < argc) {
+            arguments->heapStart = (unsigned int)strtoul(argv[++argumentIndex], NULL, 16);
+        } else if(isText(argv[argumentIndex], "-repeat") && argumentIndex + 1 < argc) {
+            arguments->repeat = (unsigned int)strtoul(argv[++argumentIndex], NULL, 10);
+        } else if(isText(argv[argumentIndex], "-v")) {
+            hostVerbose = 1;
+        } else if(argv[argumentIndex][0] != '-' && arguments->traceName == NULL) {
+            arguments->traceName = argv[argumentIndex];
+        } else {
+            fprintf(stderr, "Error: Unknown argument: %s.\n", argv[argumentIndex]);
+            usage();
+            return EXIT_FAILURE;
+        }
+    }
+
+    if(arguments->traceName == NULL || arguments->kilobytes == 0 ||
+       arguments->kilobytes > 640 || arguments->repeat == 0) {
+        usage();
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
+
+static void addOperation(struct Trace *trace, struct Operation *operation) {
+    if(trace->count == trace->capacity) {
+        trace->capacity = trace->capacity ? trace->capacity * 2 : 1024;
+        trace->operations = (struct Operation *)realloc(trace->operations,
+                                                        trace->capacity * sizeof(struct Operation));
+        if(!trace->operations) {
+            fprintf(stderr, "Error: Out of memory\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+    trace->operations[trace->count++] = *operation;
+}
+
+int readTrace(char *traceName, struct Trace *trace) {
+    /* @see traceAllocation, traceFree in kernel\memory.c */
+    char line[LINE_SIZE];
+    char *record;
+    unsigned int high, low, addressHigh, addressLow, caller, isAligned;
+    struct Operation operation;
+    FILE *traceFile;
+
+    traceFile = fopen(traceName, "r");
+    if(traceFile == NULL) {
+        fprintf(stderr, "Error: Cannot open trace file: %s\n", traceName);
+        return EXIT_FAILURE;
+    }
+
+    while(fgets(line, sizeof(line), traceFile)) {
+        if((record = findText(line, "@kmalloc ")) != NULL &&
+           sscanf(record, "@kmalloc size=%x:%x aligned=%u address=%x:%x caller=%x",
+                  &high, &low, &isAligned, &addressHigh, &addressLow, &caller) == 6) {
+            operation.type = OPERATION_MALLOC;
+            operation.size = ((unsigned long)high << 16) | low;
+            operation.isAligned = isAligned;
+        } else if((record = findText(line, "@kfree ")) != NULL &&
+                  sscanf(record, "@kfree address=%x:%x caller=%x",
+                         &addressHigh, &addressLow, &caller) == 3) {
+            operation.type = OPERATION_FREE;
+            operation.size = 0;
+            operation.isAligned = 0;
+        } else {
+            continue; /* other LOGGER output */
+        }
+        operation.traceAddress = ((unsigned long)addressHigh << 16) | addressLow;
+        operation.caller = caller;
+        addOperation(trace, &operation);
+    }
+
+    fclose(traceFile);
+    return EXIT_SUCCESS;
+}
+
+static void initializeAddressMap(struct AddressMap *map, unsigned long operationsCount) {
+    map->capacity = 1024;
+    while(map->capacity < operationsCount * 2) {
+        map->capacity <<= 1;
+    }
+    map->keys = (unsigned long *)calloc(map->capacity, sizeof(unsigned long));
+    map->values = (void **)calloc(map->capacity, sizeof(void *));
+    if(!map->keys || !map->values) {
+        fprintf(stderr, "Error: Out of memory\n");
+        exit(EXIT_FAILURE);
+    }
+}
+
+static void clearAddressMap(struct AddressMap *map) {
+    unsigned long index;
+    for(index = 0; index < map->capacity; index++) {
+        map->keys[index] = 0;
+        map->values[index] = NULL;
+    }
+}
+
+static unsigned long findAddressSlot(struct AddressMap *map, unsigned long key) {
+    /* key 0 marks an empty slot, trace addresses are never 0 */
+    unsigned long index = (key * 2654435761UL) & (map->capacity - 1);
+    while(map->keys[index] != 0 && map->keys[index] != key) {
+        index = (index + 1) & (map->capacity - 1);
+    }
+    return index;
+}
+
+static void *takeAddress(struct AddressMap *map, unsigned long key) {
+    /* remove and rehash the following cluster */
+    unsigned long index = findAddressSlot(map, key);
+    unsigned long nextIndex;
+    unsigned long movedKey;
+    void *movedValue;
+    void *value = map->values[index];
+
+    if(map->keys[index] == 0) {
+        return NULL;
+    }
+    map->keys[index] = 0;
+    map->values[index] = NULL;
+
+    for(nextIndex = (index + 1) & (map->capacity - 1); map->keys[nextIndex] != 0;
+        nextIndex = (nextIndex + 1) & (map->capacity - 1)) {
+        movedKey = map->keys[nextIndex];
+        movedValue = map->values[nextIndex];
+        map->keys[nextIndex] = 0;
+        map->values[nextIndex] = NULL;
+        index = findAddressSlot(map, movedKey);
+        map->keys[index] = movedKey;
+        map->values[index] = movedValue;
+    }
+    return value;
+}
+
+static void replayOperation(struct AddressMap *map, struct Operation *operation, unsigned long *failures) {
+    void *address;
+    unsigned long index;
+
+    if(operation->type == OPERATION_MALLOC) {
+        address = operation->isAligned ? kmalloc_align(operation->size) : kmalloc(operation->size);
+        if(!address) {
+            (*failures)++;
+            return;
+        }
+        if(operation->traceAddress) {
+            index = findAddressSlot(map, operation->traceAddress);
+            map->keys[index] = operation->traceAddress;
+            map->values[index] = address;
+        }
+        return;
+    }
+    kfree(takeAddress(map, operation->traceAddress));
+}
+
+static double getSeconds(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (double)now.tv_sec + (double)now.tv_nsec / 1e9;
+}
+
+static double getFragmentation(struct HeapStatistics *statistics) {
+    /* 1 - largest hole / all free bytes, the untouched area is one hole */
+    unsigned long largest = statistics->largestFreeBlock;
+    unsigned long total = statistics->freeBytes + statistics->untouchedBytes;
+    if(statistics->untouchedBytes > largest) {
+        largest = statistics->untouchedBytes;
+    }
+    if(total == 0) {
+        return 0.0;
+    }
+    return 1.0 - (double)largest / (double)total;
+}
+
+static void addLeak(struct CallerLeak *leaks, unsigned int *leaksCount, unsigned int caller, unsigned long size) {
+    unsigned int index;
+    for(index = 0; index < *leaksCount; index++) {
+        if(leaks[index].caller == caller) {
+            break;
+        }
+    }
+    if(index == *leaksCount) {
+        if(*leaksCount == MAX_CALLERS) {
+            return;
+        }
+        leaks[index].caller = caller;
+        leaks[index].blocks = 0;
+        leaks[index].bytes = 0;
+        (*leaksCount)++;
+    }
+    leaks[index].blocks++;
+    leaks[index].bytes += size;
+}
+
+static void reportLeaks(struct Trace *trace) {
+    /* allocations of the trace that are never freed, grouped by caller */
+    struct AddressMap live;
+    struct CallerLeak leaks[MAX_CALLERS];
+    unsigned int leaksCount = 0;
+    unsigned long index;
+    unsigned long slot;
+    struct Operation *operation;
+
+    initializeAddressMap(&live, trace->count);
+    for(index = 0; index < trace->count; index++) {
+        operation = &trace->operations[index];
+        if(operation->type == OPERATION_MALLOC && operation->traceAddress) {
+            slot = findAddressSlot(&live, operation->traceAddress);
+            live.keys[slot] = operation->traceAddress;
+            live.values[slot] = operation;
+        }
+        else if(operation->type == OPERATION_FREE) {
+            (void)takeAddress(&live, operation->traceAddress);
+        }
+    }
+
+    for(slot = 0; slot < live.capacity; slot++) {
+        if(live.keys[slot]) {
+            operation = (struct Operation *)live.values[slot];
+            addLeak(leaks, &leaksCount, operation->caller, operation->size);
+        }
+    }
+
+    printf("outstanding at end of trace:\n");
+    if(leaksCount == 0) {
+        printf("\tnone\n");
+    }
+    for(index = 0; index < leaksCount; index++) {
+        printf("\tcaller %04x: %lu blocks, %lu bytes\n",
+               leaks[index].caller, leaks[index].blocks, leaks[index].bytes);
+    }
+
+    free(live.keys);
+    free(live.values);
+}
+
+int main(int argc, char *argv[]) {
+    struct Arguments arguments;
+    struct Trace trace = {NULL, 0, 0};
+    struct AddressMap map;
+    struct HeapStatistics statistics;
+    unsigned long index;
+    unsigned long failures = 0;
+    unsigned long peakFootprint = 0;
+    unsigned long mallocs = 0;
+    double peakFragmentation = 0.0;
+    double fragmentation;
+    double elapsed = 0.0;
+    double start;
+    unsigned int run;
+
+    if(parseArguments(argc, argv, &arguments) == EXIT_FAILURE) {
+        return EXIT_FAILURE;
+    }
+    if(readTrace(arguments.traceName, &trace) == EXIT_FAILURE) {
+        return EXIT_FAILURE;
+    }
+    if(trace.count == 0) {
+        fprintf(stderr, "Error: No @kmalloc/@kfree records in %s\n", arguments.traceName);
+        return EXIT_FAILURE;
+    }
+    initializeAddressMap(&map, trace.count);
+
+    /* timed replays, the heap is reset before each one */
+    for(run = 0; run < arguments.repeat; run++) {
+        initializeHost(arguments.kilobytes, DEFAULT_KERNEL_SEGMENT);
+        initializeMemory(arguments.heapStart);
+        clearAddressMap(&map);
+        failures = 0;
+
+        start = getSeconds();
+        for(index = 0; index < trace.count; index++) {
+            replayOperation(&map, &trace.operations[index], &failures);
+        }
+        elapsed += getSeconds() - start;
+    }
+
+    /* measured replay, the heap is walked after every operation */
+    initializeHost(arguments.kilobytes, DEFAULT_KERNEL_SEGMENT);
+    initializeMemory(arguments.heapStart);
+    clearAddressMap(&map);
+    failures = 0;
+    for(index = 0; index < trace.count; index++) {
+        replayOperation(&map, &trace.operations[index], &failures);
+        if(trace.operations[index].type == OPERATION_MALLOC) {
+            mallocs++;
+        }
+        if(initializedAddress - startAddress > peakFootprint) {
+            peakFootprint = initializedAddress - startAddress;
+        }
+        getHeapStatistics(&statistics);
+        fragmentation = getFragmentation(&statistics);
+        if(fragmentation > peakFragmentation) {
+            peakFragmentation = fragmentation;
+        }
+    }
+
+    printf("trace: %s\n", arguments.traceName);
+    printf("operations: %lu (%lu kmalloc, %lu kfree), failed kmalloc: %lu\n",
+           trace.count, mallocs, trace.count - mallocs, failures);
+    printf("speed: %.0f ops/sec (%u replays)\n",
+           (double)trace.count * arguments.repeat / elapsed, arguments.repeat);
+    printf("peak footprint (initializedAddress - startAddress): %lu bytes\n", peakFootprint);
+    printf("peak in use: %lu bytes, in use at end: %lu bytes\n",
+           statistics.highWaterMark, statistics.bytesInUse);
+    printf("MCBs at end: %u (%u free), largest free block: %lu bytes\n",
+           statistics.blocks, statistics.freeBlocks, statistics.largestFreeBlock);
+    printf("fragmentation: %.1f%% at end, %.1f%% peak\n",
+           getFragmentation(&statistics) * 100.0, peakFragmentation * 100.0);
+    if(statistics.isCorrupted) {
+        printf("MCB chain is corrupted\n");
+    }
+    reportLeaks(&trace);
+
+    free(map.keys);
+    free(map.values);
+    free(trace.operations);
+    return statistics.isCorrupted ? EXIT_FAILURE : EXIT_SUCCESS;
+}
\ No newline at end of file
@@ -0,0 +1,433 @@
+/************************************************************************
+* Copyright (C) 2020 by Ahmad Dajani                                    *
+*                                                                       *
+* This file is part of NOS.                                             *
+*                                                                       *
+* NOS is free software: you can redistribute it and/or modify it        *
+* under the terms of the GNU Lesser General Public License as published *
+* by the Free Software Foundation, either version 3 of the License, or  *
+* (at your option) any later version.                                   *
+*                                                                       *
+* NOS is distributed in the hope that it will be useful,                *
+* but WITHOUT ANY WARRANTY* without even the implied warranty of        *
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+* GNU Lesser General Public License for more details.                   *
+*                                                                       *
+* You should have received a copy of the GNU Lesser General Public      *
+* License along with NOS.  If not, see <http://www.gnu.org/licenses/>.  *
+************************************************************************/
+
+/*@file nosexe.c
+* @author Ahmad Dajani <eng.adajani@gmail.com>
+* @date 19 Oct 2026
+* @brief MZ to NOS native executable (NXE) converter
+* @description Convert DOS EXE files into NXE, the relocation table is sorted,
+*              grouped in windows and delta encoded. The image can be linked
+*              for a fixed segment to skip the fixups at load time, or
+*              split in shared code and private data.
+*/
+
+#include <stdio.h> /* printf, fprintf, stderr, FILE, fopen, fread, fwrite, fseek, fputc, fclose */
+#include <stdlib.h> /* EXIT_SUCCESS, EXIT_FAILURE, strtoul */
+#include <string.h> /* strcpy, stricmp */
+#include <alloc.h> /* farcalloc, farfree */
+#include <kernel/nxe.h> /* NativeExecutableFile */
+
+#define VERSION "0.1"
+/* @see include\kernel\disk.h */
+#define SECTOR_SIZE 512
+#define FILE_NAME_SIZE 80
+/* @see include\kernel\exec.h */
+#define EXE_SIGNATURE 0x5a4d
+/* the encoded fixups take at most 7 bytes each and must fit 64KB */
+#define NOSEXE_MAX_FIXUPS 9000
+
+struct ExecutableFile {
+    unsigned int signature; /* MZ */
+    unsigned int imageLength; /* mod 512 */
+    unsigned int fileSize; /* in 512 byte pages */
+    unsigned int relocationItems;
+    unsigned int headerSize; /* in 16 byte paragraphs */
+    unsigned int minParagraphs;
+    unsigned int maxParagraphs;
+    unsigned int stackSegment; /* in paras */
+    unsigned int stackPointer;
+    unsigned int checksum; /* negative of pgm */
+    unsigned int instructionPointer;
+    unsigned int codeSegment;
+    unsigned int relocationItemOffset;
+    unsigned int overlayNumber; /* 0 for root program */
+};
+
+struct RelocationTable {
+    unsigned int offset;
+    unsigned int segment;
+};
+
+struct Arguments {
+    char exeName[FILE_NAME_SIZE];
+    char outName[FILE_NAME_SIZE];
+    unsigned int linkedBase;
+    unsigned int isStripped;
+    unsigned int isShared;
+    unsigned int codeParagraphs; /* 0 for the MZ stack segment */
+};
+
+void usage(void) {
+    printf("NOS native executable converter, version %s\n"
+           "(c)2020, By Ahmad Dajani, eng.adajani@gmail.com\n"
+           "Usage: nosexe.exe -exe [exeFile] -out [nxeFile] [-base segment] [-strip] [-share] [-code paragraphs]\n"
+           "Where:\n"
+           "    -exe   [required]  DOS MZ executable.\n"
+           "    -out   [required]  NXE file to create.\n"
+           "    -base  [optional]  Apply the fixups for this segment (hex).\n"
+           "    -strip [optional]  Drop the fixups, the image loads at -base only.\n"
+           "    -share [optional]  Share the code between instances, the code ends\n"
+           "                       at the stack segment (small model DGROUP).\n"
+           "    -code  [optional]  Code size in paragraphs for -share (hex).\n"
+           "Example: Converting shell.exe\n"
+           "    nosexe.exe -exe shell.exe -out shell.nxe\n"
+           "    nosexe.exe -exe tool.exe -out tool.nxe -share\n"
+           , VERSION);
+}
+
+int parseArguments(int argc, char* argv[], struct Arguments *arguments) {
+    register unsigned int argumentIndex;
+
+    arguments->exeName[0] = '\0';
+    arguments->outName[0] = '\0';
+    arguments->linkedBase = 0;
+    arguments->isStripped = 0;
+    arguments->isShared = 0;
+    arguments->codeParagraphs = 0;
+
+    for(argumentIndex=1; argumentIndex<argc; argumentIndex++) {
+        if(stricmp(argv[argumentIndex], "-exe") == 0 && argumentIndex + 1 < argc) {
+            argumentIndex += 1;
+            strcpy(arguments->exeName, argv[argumentIndex]);
+        } else if(stricmp(argv[argumentIndex], "-out") == 0 && argumentIndex + 1 < argc) {
+            argumentIndex += 1;
+            strcpy(arguments->outName, argv[argumentIndex]);
+        } else if(stricmp(argv[argumentIndex], "-base") == 0 && argumentIndex + 1 < argc) {
+            argumentIndex += 1;
+            arguments->linkedBase = (unsigned int)strtoul(argv[argumentIndex], NULL, 16);
+        } else if(stricmp(argv[argumentIndex], "-strip") == 0) {
+            arguments->isStripped = 1;
+        } else if(stricmp(argv[argumentIndex], "-share") == 0) {
+            arguments->isShared = 1;
+        } else if(stricmp(argv[argumentIndex], "-code") == 0 && argumentIndex + 1 < argc) {
+            argumentIndex += 1;
+            arguments->codeParagraphs = (unsigned int)strtoul(argv[argumentIndex], NULL, 16);
+        } else {
+            fprintf(stderr, "Error: Unknown argument: %s.\n", argv[argumentIndex]);
+            usage();
+            return EXIT_FAILURE;
+        }
+    }
+
+    if(arguments->exeName[0] == '\0' || arguments->outName[0] == '\0' ||
+       (arguments->isStripped && arguments->linkedBase == 0) ||
+       (arguments->isShared && arguments->linkedBase != 0)) {
+        usage();
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
+
+unsigned long getLoadModuleSize(struct ExecutableFile *header) {
+    /* @see executeBinary */
+    unsigned long size = (unsigned long)header->fileSize * SECTOR_SIZE;
+    if(header->imageLength) {
+        size -= SECTOR_SIZE - header->imageLength;
+    }
+    return size - ((unsigned long)header->headerSize << 4);
+}
+
+void siftDown(unsigned long far *fixups, unsigned int root, unsigned int count) {
+    unsigned int child;
+    unsigned long value;
+    while((child = root * 2 + 1) < count) {
+        if(child + 1 < count && fixups[child + 1] > fixups[child]) {
+            child++;
+        }
+        if(fixups[root] >= fixups[child]) {
+            return;
+        }
+        value = fixups[root];
+        fixups[root] = fixups[child];
+        fixups[child] = value;
+        root = child;
+    }
+}
+
+void sortFixups(unsigned long far *fixups, unsigned int count) {
+    /* heap sort, qsort can't take far data in small model */
+    unsigned int index;
+    unsigned long value;
+    for(index = count / 2; index > 0; index--) {
+        siftDown(fixups, index - 1, count);
+    }
+    for(index = count; index > 1; index--) {
+        value = fixups[0];
+        fixups[0] = fixups[index - 1];
+        fixups[index - 1] = value;
+        siftDown(fixups, 0, index - 1);
+    }
+}
+
+unsigned int putByte(unsigned char far *stream, unsigned int size, unsigned char value) {
+    stream[size] = value;
+    return size + 1;
+}
+
+unsigned int putWord(unsigned char far *stream, unsigned int size, unsigned int value) {
+    stream[size] = (unsigned char)value;
+    stream[size + 1] = (unsigned char)(value >> 8);
+    return size + 2;
+}
+
+unsigned int encodeFixups(unsigned long far *fixups, unsigned int count,
+                          unsigned char far *stream, unsigned int *windows) {
+    /* @see include\kernel\nxe.h
+       @return encoded size in bytes */
+    unsigned int size = 0;
+    unsigned int index = 0;
+    unsigned int windowCountAt;
+    unsigned int windowCount;
+    unsigned long windowBase;
+    unsigned long previous;
+    unsigned long distance;
+
+    *windows = 0;
+    while(index < count) {
+        windowBase = fixups[index] & ~15UL;
+        size = putWord(stream, size, (unsigned int)(windowBase >> 4));
+        windowCountAt = size;
+        size = putWord(stream, size, 0);
+        windowCount = 0;
+        previous = windowBase;
+        while(index < count && fixups[index] - windowBase < NXE_WINDOW_SIZE) {
+            distance = fixups[index] - previous;
+            if(distance >= 1 && distance <= 255) {
+                size = putByte(stream, size, (unsigned char)distance);
+            }
+            else {
+                size = putByte(stream, size, 0);
+                size = putWord(stream, size, (unsigned int)distance);
+            }
+            previous = fixups[index];
+            windowCount++;
+            index++;
+        }
+        (void)putWord(stream, windowCountAt, windowCount);
+        (*windows)++;
+    }
+    return size;
+}
+
+int checkSharedCode(FILE *exeFile, struct ExecutableFile *header, unsigned long loadModuleSize,
+                    unsigned long far *fixups, unsigned int count, unsigned int codeParagraphs) {
+    /* shared code is relocated once, so it can't refer to the private data */
+    unsigned long codeSize = (unsigned long)codeParagraphs << 4;
+    unsigned int index;
+    unsigned int value;
+
+    if(codeParagraphs == 0 || codeSize >= loadModuleSize ||
+       header->codeSegment >= codeParagraphs || header->stackSegment < codeParagraphs) {
+        fprintf(stderr, "Error: Entry or stack is not in the code/data split at %x\n", codeParagraphs);
+        return EXIT_FAILURE;
+    }
+    for(index = 0; index < count && fixups[index] < codeSize; index++) {
+        fseek(exeFile, ((unsigned long)header->headerSize << 4) + fixups[index], SEEK_SET);
+        if(fread(&value, sizeof(unsigned int), 1, exeFile) != 1) {
+            return EXIT_FAILURE;
+        }
+        if(value >= codeParagraphs) {
+            fprintf(stderr, "Error: Code refers to segment %x of the data at %lx\n", value, fixups[index]);
+            return EXIT_FAILURE;
+        }
+    }
+    return EXIT_SUCCESS;
+}
+
+int copyLoadModule(FILE *exeFile, FILE *nxeFile, unsigned long size,
+                   unsigned long far *fixups, unsigned int count, unsigned int base) {
+    /* copy sector by sector, adding base to the fixed up words when the
+       image is linked for a segment */
+    static unsigned char buffer[SECTOR_SIZE];
+    unsigned long position = 0;
+    unsigned int index = 0;
+    unsigned int chunk;
+    unsigned int offset;
+    unsigned int value;
+    unsigned int pendingHigh = 0; /* carried into the first byte of the next chunk */
+
+    while(position < size) {
+        chunk = size - position > SECTOR_SIZE ? SECTOR_SIZE : (unsigned int)(size - position);
+        if(fread(buffer, 1, chunk, exeFile) != chunk) {
+            return EXIT_FAILURE;
+        }
+        buffer[0] += (unsigned char)pendingHigh;
+        pendingHigh = 0;
+
+        for(; base && index < count && fixups[index] < position + chunk; index++) {
+            offset = (unsigned int)(fixups[index] - position);
+            if(offset + 1 < chunk) {
+                value = buffer[offset] | ((unsigned int)buffer[offset + 1] << 8);
+                value += base;
+                buffer[offset] = (unsigned char)value;
+                buffer[offset + 1] = (unsigned char)(value >> 8);
+            }
+            else {
+                value = buffer[offset] + (base & 0xff);
+                buffer[offset] = (unsigned char)value;
+                pendingHigh += (base >> 8) + (value >> 8);
+            }
+        }
+
+        if(fwrite(buffer, 1, chunk, nxeFile) != chunk) {
+            return EXIT_FAILURE;
+        }
+        position += chunk;
+    }
+    return EXIT_SUCCESS;
+}
+
+int main(int argc, char* argv[]) {
+    struct Arguments arguments;
+    struct ExecutableFile header;
+    struct NativeExecutableFile nativeHeader;
+    struct RelocationTable relocation;
+    unsigned long far *fixups = NULL;
+    unsigned char far *stream = NULL;
+    unsigned long loadModuleSize;
+    unsigned long headerBytes;
+    unsigned int windows = 0;
+    unsigned int streamSize = 0;
+    unsigned int index;
+    FILE *exeFile;
+    FILE *nxeFile;
+
+    if(parseArguments(argc, argv, &arguments) == EXIT_FAILURE) {
+        return EXIT_FAILURE;
+    }
+
+    exeFile = fopen(arguments.exeName, "rb");
+    if(exeFile == NULL) {
+        fprintf(stderr, "Error: Cannot open exe file: %s\n", arguments.exeName);
+        return EXIT_FAILURE;
+    }
+
+    if(fread(&header, sizeof(struct ExecutableFile), 1, exeFile) != 1 ||
+       header.signature != EXE_SIGNATURE) {
+        fprintf(stderr, "Error: Not valid exe header: %s\n", arguments.exeName);
+        fclose(exeFile);
+        return EXIT_FAILURE;
+    }
+    loadModuleSize = getLoadModuleSize(&header);
+
+    /* relocations as linear offsets in the load module */
+    if(header.relocationItems > NOSEXE_MAX_FIXUPS) {
+        fprintf(stderr, "Error: Too many relocations: %u\n", header.relocationItems);
+        fclose(exeFile);
+        return EXIT_FAILURE;
+    }
+    if(header.relocationItems) {
+        fixups = (unsigned long far *)farcalloc(header.relocationItems, sizeof(unsigned long));
+        stream = (unsigned char far *)farcalloc(header.relocationItems, 7); /* window + escaped delta */
+        if(fixups == NULL || stream == NULL) {
+            fprintf(stderr, "Error: Out of memory\n");
+            fclose(exeFile);
+            return EXIT_FAILURE;
+        }
+    }
+    fseek(exeFile, header.relocationItemOffset, SEEK_SET);
+    for(index = 0; index < header.relocationItems; index++) {
+        if(fread(&relocation, sizeof(struct RelocationTable), 1, exeFile) != 1) {
+            fprintf(stderr, "Error: Can't read relocation table\n");
+            fclose(exeFile);
+            return EXIT_FAILURE;
+        }
+        fixups[index] = ((unsigned long)relocation.segment << 4) + relocation.offset;
+        if(fixups[index] + 2 > loadModuleSize) {
+            fprintf(stderr, "Error: Fixup %x:%x is outside the load module\n",
+                    relocation.segment, relocation.offset);
+            fclose(exeFile);
+            return EXIT_FAILURE;
+        }
+    }
+    sortFixups(fixups, header.relocationItems);
+
+    if(arguments.isShared) {
+        if(arguments.codeParagraphs == 0) {
+            arguments.codeParagraphs = header.stackSegment;
+        }
+        if(checkSharedCode(exeFile, &header, loadModuleSize, fixups, header.relocationItems,
+                           arguments.codeParagraphs) == EXIT_FAILURE) {
+            fclose(exeFile);
+            return EXIT_FAILURE;
+        }
+    }
+
+    if(!arguments.isStripped) {
+        streamSize = encodeFixups(fixups, header.relocationItems, stream, &windows);
+    }
+
+    nativeHeader.signature = NXE_SIGNATURE;
+    nativeHeader.version = NXE_VERSION;
+    nativeHeader.flags = arguments.isStripped ? NXE_FIXED_BASE : 0;
+    if(arguments.isShared) {
+        nativeHeader.flags |= NXE_SHARED_CODE;
+    }
+    headerBytes = sizeof(struct NativeExecutableFile) + (unsigned long)streamSize;
+    nativeHeader.headerSectors = (unsigned int)((headerBytes + NXE_HEADER_ALIGN - 1) / NXE_HEADER_ALIGN);
+    nativeHeader.loadModuleSize = loadModuleSize;
+    nativeHeader.minParagraphs = header.minParagraphs;
+    nativeHeader.linkedBase = arguments.linkedBase;
+    nativeHeader.stackSegment = header.stackSegment;
+    nativeHeader.stackPointer = header.stackPointer;
+    nativeHeader.codeSegment = header.codeSegment;
+    nativeHeader.instructionPointer = header.instructionPointer;
+    nativeHeader.fixupWindows = windows;
+    nativeHeader.fixupsCount = arguments.isStripped ? 0 : header.relocationItems;
+    nativeHeader.fixupBytes = streamSize;
+    nativeHeader.packedSize = 0;
+    nativeHeader.codeParagraphs = arguments.isShared ? arguments.codeParagraphs : 0;
+
+    nxeFile = fopen(arguments.outName, "wb");
+    if(nxeFile == NULL) {
+        fprintf(stderr, "Error: Cannot create nxe file: %s\n", arguments.outName);
+        fclose(exeFile);
+        return EXIT_FAILURE;
+    }
+
+    /* header sectors: header, fixups and zero padding */
+    fwrite(&nativeHeader, sizeof(struct NativeExecutableFile), 1, nxeFile);
+    for(index = 0; index < streamSize; index++) {
+        fputc(stream[index], nxeFile);
+    }
+    for(; headerBytes < (unsigned long)nativeHeader.headerSectors * NXE_HEADER_ALIGN; headerBytes++) {
+        fputc(0, nxeFile);
+    }
+
+    fseek(exeFile, (unsigned long)header.headerSize << 4, SEEK_SET);
+    if(copyLoadModule(exeFile, nxeFile, loadModuleSize, fixups, header.relocationItems,
+                      arguments.linkedBase) == EXIT_FAILURE) {
+        fprintf(stderr, "Error: Can't copy the load module\n");
+        fclose(exeFile);
+        fclose(nxeFile);
+        return EXIT_FAILURE;
+    }
+
+    printf("%s: %lu bytes load module, %u fixups in %u windows, %u bytes (MZ table %lu bytes)\n",
+           arguments.outName, loadModuleSize, nativeHeader.fixupsCount, windows, streamSize,
+           (unsigned long)header.relocationItems * sizeof(struct RelocationTable));
+
+    if(fixups) {
+        farfree(fixups);
+        farfree(stream);
+    }
+    fclose(exeFile);
+    fclose(nxeFile);
+    return EXIT_SUCCESS;
+}
\ No newline at end of file
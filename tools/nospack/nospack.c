@@ -0,0 +1,274 @@
+/************************************************************************
+* Copyright (C) 2020 by Ahmad Dajani                                    *
+*                                                                       *
+* This file is part of NOS.                                             *
+*                                                                       *
+* NOS is free software: you can redistribute it and/or modify it        *
+* under the terms of the GNU Lesser General Public License as published *
+* by the Free Software Foundation, either version 3 of the License, or  *
+* (at your option) any later version.                                   *
+*                                                                       *
+* NOS is distributed in the hope that it will be useful,                *
+* but WITHOUT ANY WARRANTY* without even the implied warranty of        *
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+* GNU Lesser General Public License for more details.                   *
+*                                                                       *
+* You should have received a copy of the GNU Lesser General Public      *
+* License along with NOS.  If not, see <http://www.gnu.org/licenses/>.  *
+************************************************************************/
+
+/*@file nospack.c
+* @author Ahmad Dajani <eng.adajani@gmail.com>
+* @date 19 Oct 2026
+* @brief NXE load module packer
+* @description Pack the load module of NXE files (see tools\nosexe) with LZSS,
+*              the kernel expands it straight into the load segment. Files
+*              that don't get smaller by at least one sector are copied as is.
+*/
+
+#include <stdio.h> /* printf, fprintf, stderr, FILE, fopen, fread, fwrite, fputc, fclose */
+#include <stdlib.h> /* EXIT_SUCCESS, EXIT_FAILURE */
+#include <string.h> /* strcpy, stricmp */
+#include <alloc.h> /* farmalloc, farfree */
+#include <kernel/nxe.h> /* NativeExecutableFile, NXE_PACK_WINDOW */
+
+#define VERSION "0.1"
+/* @see include\kernel\disk.h */
+#define SECTOR_SIZE 512
+#define FILE_NAME_SIZE 80
+#define HASH_SIZE 4096
+#define MAX_CHAIN 32
+
+struct Arguments {
+    char inName[FILE_NAME_SIZE];
+    char outName[FILE_NAME_SIZE];
+};
+
+/* last position + 1 of each 3 bytes hash, and the previous one in the window */
+static unsigned long hashHead[HASH_SIZE];
+static unsigned long hashPrevious[NXE_PACK_WINDOW];
+static unsigned char buffer[SECTOR_SIZE];
+
+void usage(void) {
+    printf("NXE packer, version %s\n"
+           "(c)2020, By Ahmad Dajani, eng.adajani@gmail.com\n"
+           "Usage: nospack.exe -in [nxeFile] -out [nxeFile]\n"
+           "Where:\n"
+           "    -in    [required]  NXE file created by nosexe.\n"
+           "    -out   [required]  Packed NXE file to create.\n"
+           "Example: Packing shell.nxe\n"
+           "    nospack.exe -in shell.nxe -out shellp.nxe\n"
+           , VERSION);
+}
+
+int parseArguments(int argc, char* argv[], struct Arguments *arguments) {
+    register unsigned int argumentIndex;
+
+    if(argc != 5) {
+        usage();
+        return EXIT_FAILURE;
+    }
+
+    for(argumentIndex=1; argumentIndex<argc; argumentIndex++) {
+        if(stricmp(argv[argumentIndex], "-in") == 0) {
+            argumentIndex += 1;
+            strcpy(arguments->inName, argv[argumentIndex]);
+        } else if(stricmp(argv[argumentIndex], "-out") == 0) {
+            argumentIndex += 1;
+            strcpy(arguments->outName, argv[argumentIndex]);
+        } else {
+            fprintf(stderr, "Error: Unknown argument: %s.\n", argv[argumentIndex]);
+            usage();
+            return EXIT_FAILURE;
+        }
+    }
+
+    return EXIT_SUCCESS;
+}
+
+int readBlock(FILE *inFile, unsigned char huge *block, unsigned long size) {
+    /* fread takes near buffers in small model */
+    unsigned int chunk;
+    unsigned int index;
+    while(size) {
+        chunk = size > SECTOR_SIZE ? SECTOR_SIZE : (unsigned int)size;
+        if(fread(buffer, 1, chunk, inFile) != chunk) {
+            return EXIT_FAILURE;
+        }
+        for(index = 0; index < chunk; index++) {
+            *block++ = buffer[index];
+        }
+        size -= chunk;
+    }
+    return EXIT_SUCCESS;
+}
+
+void writeBlock(FILE *outFile, unsigned char huge *block, unsigned long size) {
+    while(size--) {
+        fputc(*block++, outFile);
+    }
+}
+
+unsigned int getHash(unsigned char huge *data) {
+    return ((data[0] << 4) ^ (data[1] << 2) ^ data[2]) & (HASH_SIZE - 1);
+}
+
+void insertPosition(unsigned char huge *module, unsigned long position) {
+    unsigned int hash = getHash(module + position);
+    hashPrevious[(unsigned int)(position & (NXE_PACK_WINDOW - 1))] = hashHead[hash];
+    hashHead[hash] = position + 1;
+}
+
+unsigned int findMatch(unsigned char huge *module, unsigned long position, unsigned long size,
+                       unsigned int *distance) {
+    /* longest match in the window, following the hash chain */
+    unsigned long candidate = hashHead[getHash(module + position)];
+    unsigned int maxLength = size - position > NXE_PACK_MAX_MATCH ? NXE_PACK_MAX_MATCH : (unsigned int)(size - position);
+    unsigned int bestLength = 0;
+    unsigned int length;
+    unsigned int chain;
+
+    for(chain = 0; candidate && chain < MAX_CHAIN; chain++) {
+        candidate--;
+        if(position - candidate >= NXE_PACK_WINDOW) {
+            break;
+        }
+        for(length = 0; length < maxLength && module[candidate + length] == module[position + length]; length++);
+        if(length > bestLength) {
+            bestLength = length;
+            *distance = (unsigned int)(position - candidate);
+            if(length == maxLength) {
+                break;
+            }
+        }
+        candidate = hashPrevious[(unsigned int)(candidate & (NXE_PACK_WINDOW - 1))];
+    }
+    return bestLength;
+}
+
+unsigned long packModule(unsigned char huge *module, unsigned long size, unsigned char huge *packed) {
+    /* @see include\kernel\nxe.h
+       @return packed size in bytes */
+    unsigned long position = 0;
+    unsigned long packedSize = 0;
+    unsigned long flagsAt = 0;
+    unsigned int flagBit = 8;
+    unsigned int distance = 0;
+    unsigned int length;
+    unsigned int index;
+
+    for(index = 0; index < HASH_SIZE; index++) {
+        hashHead[index] = 0;
+    }
+
+    while(position < size) {
+        if(flagBit == 8) {
+            flagsAt = packedSize++;
+            packed[flagsAt] = 0;
+            flagBit = 0;
+        }
+
+        length = size - position >= NXE_PACK_MIN_MATCH ? findMatch(module, position, size, &distance) : 0;
+        if(length >= NXE_PACK_MIN_MATCH) {
+            packed[packedSize++] = (unsigned char)distance;
+            packed[packedSize++] = (unsigned char)(((distance >> 4) & 0xf0) | (length - NXE_PACK_MIN_MATCH));
+        }
+        else {
+            length = 1;
+            packed[flagsAt] |= 1 << flagBit;
+            packed[packedSize++] = module[position];
+        }
+        flagBit++;
+
+        while(length--) {
+            if(size - position >= NXE_PACK_MIN_MATCH) {
+                insertPosition(module, position);
+            }
+            position++;
+        }
+    }
+    return packedSize;
+}
+
+int main(int argc, char* argv[]) {
+    struct Arguments arguments;
+    struct NativeExecutableFile nativeHeader;
+    unsigned char huge *headerSectors;
+    unsigned char huge *module;
+    unsigned char huge *packed;
+    unsigned long headerBytes;
+    unsigned long packedSize;
+    FILE *inFile;
+    FILE *outFile;
+
+    if(parseArguments(argc, argv, &arguments) == EXIT_FAILURE) {
+        return EXIT_FAILURE;
+    }
+
+    inFile = fopen(arguments.inName, "rb");
+    if(inFile == NULL) {
+        fprintf(stderr, "Error: Cannot open nxe file: %s\n", arguments.inName);
+        return EXIT_FAILURE;
+    }
+
+    if(fread(&nativeHeader, sizeof(struct NativeExecutableFile), 1, inFile) != 1 ||
+       nativeHeader.signature != NXE_SIGNATURE || nativeHeader.version != NXE_VERSION ||
+       (nativeHeader.flags & NXE_COMPRESSED)) {
+        fprintf(stderr, "Error: Not valid or already packed nxe file: %s\n", arguments.inName);
+        fclose(inFile);
+        return EXIT_FAILURE;
+    }
+
+    headerBytes = (unsigned long)nativeHeader.headerSectors * SECTOR_SIZE;
+    headerSectors = (unsigned char huge *)farmalloc(headerBytes);
+    module = (unsigned char huge *)farmalloc(nativeHeader.loadModuleSize + 1);
+    /* worst case: one flag byte per 8 literals */
+    packed = (unsigned char huge *)farmalloc(nativeHeader.loadModuleSize + nativeHeader.loadModuleSize / 8 + 2);
+    if(headerSectors == NULL || module == NULL || packed == NULL) {
+        fprintf(stderr, "Error: Out of memory\n");
+        fclose(inFile);
+        return EXIT_FAILURE;
+    }
+
+    fseek(inFile, 0, SEEK_SET);
+    if(readBlock(inFile, headerSectors, headerBytes) == EXIT_FAILURE ||
+       readBlock(inFile, module, nativeHeader.loadModuleSize) == EXIT_FAILURE) {
+        fprintf(stderr, "Error: Can't read nxe file: %s\n", arguments.inName);
+        fclose(inFile);
+        return EXIT_FAILURE;
+    }
+    fclose(inFile);
+
+    packedSize = packModule(module, nativeHeader.loadModuleSize, packed);
+
+    outFile = fopen(arguments.outName, "wb");
+    if(outFile == NULL) {
+        fprintf(stderr, "Error: Cannot create nxe file: %s\n", arguments.outName);
+        return EXIT_FAILURE;
+    }
+
+    if((nativeHeader.flags & NXE_SHARED_CODE) ||
+       (packedSize + SECTOR_SIZE - 1) / SECTOR_SIZE >= (nativeHeader.loadModuleSize + SECTOR_SIZE - 1) / SECTOR_SIZE) {
+        /* no sector saved or the code is shared (read apart from the data),
+           keep the plain load module */
+        writeBlock(outFile, headerSectors, headerBytes);
+        writeBlock(outFile, module, nativeHeader.loadModuleSize);
+        printf("%s: stored, %lu bytes don't pack\n", arguments.outName, nativeHeader.loadModuleSize);
+    }
+    else {
+        nativeHeader.flags |= NXE_COMPRESSED;
+        nativeHeader.packedSize = packedSize;
+        fwrite(&nativeHeader, sizeof(struct NativeExecutableFile), 1, outFile);
+        writeBlock(outFile, headerSectors + sizeof(struct NativeExecutableFile),
+                   headerBytes - sizeof(struct NativeExecutableFile));
+        writeBlock(outFile, packed, packedSize);
+        printf("%s: packed %lu bytes to %lu bytes\n", arguments.outName,
+               nativeHeader.loadModuleSize, packedSize);
+    }
+
+    farfree(headerSectors);
+    farfree(module);
+    farfree(packed);
+    fclose(outFile);
+    return EXIT_SUCCESS;
+}
\ No newline at end of file
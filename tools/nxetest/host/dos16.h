@@ -0,0 +1,39 @@
+/************************************************************************
+* Copyright (C) 2020 by Ahmad Dajani                                    *
+*                                                                       *
+* This file is part of NOS.                                             *
+*                                                                       *
+* NOS is free software: you can redistribute it and/or modify it        *
+* under the terms of the GNU Lesser General Public License as published *
+* by the Free Software Foundation, either version 3 of the License, or  *
+* (at your option) any later version.                                   *
+*                                                                       *
+* NOS is distributed in the hope that it will be useful,                *
+* but WITHOUT ANY WARRANTY* without even the implied warranty of        *
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+* GNU Lesser General Public License for more details.                   *
+*                                                                       *
+* You should have received a copy of the GNU Lesser General Public      *
+* License along with NOS.  If not, see <http://www.gnu.org/licenses/>.  *
+************************************************************************/
+
+/*@file dos16.h
+* @author Ahmad Dajani <eng.adajani@gmail.com>
+* @date 19 Oct 2026
+* @brief Included first in every host build of a NOS source
+* @note The C library is declared before the Turbo C structures, which are
+*       byte aligned as on the target. The types come from dos16.sed.
+*/
+
+#ifndef __DOS16_H
+    #define __DOS16_H
+    #include <stdint.h> /* int16_t, uint16_t, int32_t, uint32_t */
+    #include <stdio.h> /* FILE, printf, fopen, fread, fwrite */
+    #include <stdlib.h> /* malloc, calloc, free, strtoul */
+    #include <string.h> /* strcpy, memcmp */
+    #include <strings.h> /* strcasecmp */
+
+    #define stricmp strcasecmp
+
+    #pragma pack(1)
+#endif
\ No newline at end of file
@@ -0,0 +1,63 @@
+/************************************************************************
+* Copyright (C) 2020 by Ahmad Dajani                                    *
+*                                                                       *
+* This file is part of NOS.                                             *
+*                                                                       *
+* NOS is free software: you can redistribute it and/or modify it        *
+* under the terms of the GNU Lesser General Public License as published *
+* by the Free Software Foundation, either version 3 of the License, or  *
+* (at your option) any later version.                                   *
+*                                                                       *
+* NOS is distributed in the hope that it will be useful,                *
+* but WITHOUT ANY WARRANTY* without even the implied warranty of        *
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+* GNU Lesser General Public License for more details.                   *
+*                                                                       *
+* You should have received a copy of the GNU Lesser General Public      *
+* License along with NOS.  If not, see <http://www.gnu.org/licenses/>.  *
+************************************************************************/
+
+/*@file host.c
+* @author Ahmad Dajani <eng.adajani@gmail.com>
+* @date 19 Oct 2026
+* @brief Simulated real mode memory to build kernel/nxeload.c on the host
+*/
+
+#include <stdio.h> /* vfprintf, fseek, fread, stderr */
+#include <stdlib.h> /* calloc, exit */
+#include <stdarg.h> /* va_list */
+#include "host.h"
+#include "conio.h"
+#include "kernel/filesys.h"
+
+unsigned char *simulatedMemory = NULL;
+int hostVerbose = 0;
+
+void initializeHost(void) {
+    if(!simulatedMemory) {
+        simulatedMemory = (unsigned char *)calloc(SIMULATED_MEMORY_SIZE, 1);
+        if(!simulatedMemory) {
+            fprintf(stderr, "Error: Cannot allocate simulated memory\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+}
+
+void printFormat(enum PRINT_STREAM stream, char *format, ...) {
+    va_list arg;
+    (void)stream;
+    if(!hostVerbose) {
+        return;
+    }
+    va_start(arg, format);
+    vfprintf(stderr, format, arg);
+    va_end(arg);
+}
+
+uint32_t readFile(struct File *file, uint32_t offset, void *outBuffer, uint32_t length) {
+    /* as the kernel, @return the bytes read */
+    if(offset >= file->size || fseek(file->stream, offset, SEEK_SET) != 0) {
+        return 0;
+    }
+    return (uint32_t)fread(outBuffer, 1, length, file->stream);
+}
\ No newline at end of file
@@ -0,0 +1,39 @@
+/************************************************************************
+* Copyright (C) 2020 by Ahmad Dajani                                    *
+*                                                                       *
+* This file is part of NOS.                                             *
+*                                                                       *
+* NOS is free software: you can redistribute it and/or modify it        *
+* under the terms of the GNU Lesser General Public License as published *
+* by the Free Software Foundation, either version 3 of the License, or  *
+* (at your option) any later version.                                   *
+*                                                                       *
+* NOS is distributed in the hope that it will be useful,                *
+* but WITHOUT ANY WARRANTY* without even the implied warranty of        *
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+* GNU Lesser General Public License for more details.                   *
+*                                                                       *
+* You should have received a copy of the GNU Lesser General Public      *
+* License along with NOS.  If not, see <http://www.gnu.org/licenses/>.  *
+************************************************************************/
+
+/*@file host.h
+* @author Ahmad Dajani <eng.adajani@gmail.com>
+* @date 19 Oct 2026
+* @brief Simulated real mode memory to build kernel/nxeload.c on the host
+* @note Linear address 0 of the simulated machine is simulatedMemory[0],
+*       far pointers are plain host pointers into it.
+*/
+
+#ifndef __HOST_H
+    #define __HOST_H
+    #include <stdint.h> /* uint32_t */
+
+    /* 1MB real mode address space and the wrap of FFFF:FFFF */
+    #define SIMULATED_MEMORY_SIZE 0x110000UL
+
+    extern unsigned char *simulatedMemory;
+    extern int hostVerbose; /* print printFormat output on stderr */
+
+    void initializeHost(void);
+#endif
\ No newline at end of file
@@ -0,0 +1,39 @@
+/************************************************************************
+* Copyright (C) 2020 by Ahmad Dajani                                    *
+*                                                                       *
+* This file is part of NOS.                                             *
+*                                                                       *
+* NOS is free software: you can redistribute it and/or modify it        *
+* under the terms of the GNU Lesser General Public License as published *
+* by the Free Software Foundation, either version 3 of the License, or  *
+* (at your option) any later version.                                   *
+*                                                                       *
+* NOS is distributed in the hope that it will be useful,                *
+* but WITHOUT ANY WARRANTY* without even the implied warranty of        *
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+* GNU Lesser General Public License for more details.                   *
+*                                                                       *
+* You should have received a copy of the GNU Lesser General Public      *
+* License along with NOS.  If not, see <http://www.gnu.org/licenses/>.  *
+************************************************************************/
+
+/*@file filesys.h
+* @author Ahmad Dajani <eng.adajani@gmail.com>
+* @date 19 Oct 2026
+* @brief Host replacement of include/kernel/filesys.h
+*/
+
+#ifndef __FILESYS_H
+    #define __FILESYS_H
+    #define SECTOR_SIZE 512 /* @see include/kernel/disk.h */
+    #include <stdio.h> /* FILE */
+    #include <stdint.h> /* uint32_t */
+
+    /* a file opened on the host */
+    struct File {
+        FILE *stream;
+        uint32_t size;
+    };
+
+    uint32_t readFile(struct File *file, uint32_t offset, void *outBuffer, uint32_t length);
+#endif
\ No newline at end of file
@@ -0,0 +1,35 @@
+/************************************************************************
+* Copyright (C) 2020 by Ahmad Dajani                                    *
+*                                                                       *
+* This file is part of NOS.                                             *
+*                                                                       *
+* NOS is free software: you can redistribute it and/or modify it        *
+* under the terms of the GNU Lesser General Public License as published *
+* by the Free Software Foundation, either version 3 of the License, or  *
+* (at your option) any later version.                                   *
+*                                                                       *
+* NOS is distributed in the hope that it will be useful,                *
+* but WITHOUT ANY WARRANTY* without even the implied warranty of        *
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+* GNU Lesser General Public License for more details.                   *
+*                                                                       *
+* You should have received a copy of the GNU Lesser General Public      *
+* License along with NOS.  If not, see <http://www.gnu.org/licenses/>.  *
+************************************************************************/
+
+/*@file string.h
+* @author Ahmad Dajani <eng.adajani@gmail.com>
+* @date 19 Oct 2026
+* @brief Host replacement of include/string.h
+* @note The C library string.h is still needed by the tools.
+*/
+
+#ifndef __STRING_H
+    #define __STRING_H
+    #include_next <string.h>
+    #include "host.h"
+
+    #define MK_FP(seg, ofs) ((void *)(simulatedMemory + ((uint32_t)(uint16_t)(seg) << 4) + (uint16_t)(ofs)))
+    #define FP_SEG(fp) ((uint16_t)(((unsigned char *)(fp) - simulatedMemory) >> 4))
+    #define FP_OFF(fp) ((uint16_t)(((unsigned char *)(fp) - simulatedMemory) & 0xf))
+#endif
\ No newline at end of file
@@ -0,0 +1,438 @@
+/************************************************************************
+* Copyright (C) 2020 by Ahmad Dajani                                    *
+*                                                                       *
+* This file is part of NOS.                                             *
+*                                                                       *
+* NOS is free software: you can redistribute it and/or modify it        *
+* under the terms of the GNU Lesser General Public License as published *
+* by the Free Software Foundation, either version 3 of the License, or  *
+* (at your option) any later version.                                   *
+*                                                                       *
+* NOS is distributed in the hope that it will be useful,                *
+* but WITHOUT ANY WARRANTY* without even the implied warranty of        *
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+* GNU Lesser General Public License for more details.                   *
+*                                                                       *
+* You should have received a copy of the GNU Lesser General Public      *
+* License along with NOS.  If not, see <http://www.gnu.org/licenses/>.  *
+************************************************************************/
+
+/*@file nxetest.c
+* @author Ahmad Dajani <eng.adajani@gmail.com>
+* @date 19 Oct 2026
+* @brief Host round trip test of the NXE tools and loader
+* @description Build an MZ image with known fixups, convert it with the host
+*              build of tools\nosexe and load it with kernel\nxeload.c in a
+*              simulated memory, at the linked base, at other bases and as
+*              two instances of shared code. The NXE is packed with the host
+*              build of tools\nospack and unpacked by the kernel code. The
+*              loaded image is compared byte by byte with the expected image.
+* @note Every NOS source is compiled as is after host\dos16.sed, so int is
+*       16 bit and long is 32 bit as on the target.
+*/
+
+#include <stdio.h> /* printf, fopen, fwrite, fclose, remove */
+#include <stdlib.h> /* malloc, free, system, strtoul */
+#include <string.h> /* memcmp, memcpy */
+#include <kernel/nxeload.h> /* relocateNativeImage, NativeExecutableFile */
+#include "host.h" /* initializeHost */
+
+#define EXE_NAME "nxetest.exe"
+#define NXE_NAME "nxetest.nxe"
+#define BASE_NAME "nxetestb.nxe"
+#define STRIP_NAME "nxetests.nxe"
+#define SHARE_NAME "nxetestc.nxe"
+#define PACK_NAME "nxetestp.nxe"
+#define SHARE_PACK_NAME "nxetestq.nxe"
+#define SECTOR_SIZE 512
+#define EXE_HEADER_PARAGRAPHS 0x400 /* header and relocation table */
+#define MAX_FIXUPS 4000 /* relocation table within EXE_HEADER_PARAGRAPHS */
+#define DEFAULT_SEED 2026
+
+/* test image: code refers to the code only, @see nosexe -share */
+#define CODE_PARAGRAPHS 0x1200
+#define DATA_PARAGRAPHS 0x0e00
+#define MODULE_TAIL 9 /* load module is not a multiple of a paragraph */
+#define MIN_PARAGRAPHS 0x100
+
+/* simulated segments */
+#define LINKED_BASE 0x2345
+#define LOAD_BASE 0x1000
+#define CODE_BASE 0x4000
+#define DATA_BASE 0x5800
+#define SECOND_DATA_BASE 0x7000
+#define OTHER_BASE 0x9000
+#define PACK_BASE 0xb000
+
+/* @see include\kernel\exec.h */
+struct ExecutableFile {
+    unsigned int signature; /* MZ */
+    unsigned int imageLength; /* mod 512 */
+    unsigned int fileSize; /* in 512 byte pages */
+    unsigned int relocationItems;
+    unsigned int headerSize; /* in 16 byte paragraphs */
+    unsigned int minParagraphs;
+    unsigned int maxParagraphs;
+    unsigned int stackSegment; /* in paras */
+    unsigned int stackPointer;
+    unsigned int checksum; /* negative of pgm */
+    unsigned int instructionPointer;
+    unsigned int codeSegment;
+    unsigned int relocationItemOffset;
+    unsigned int overlayNumber; /* 0 for root program */
+};
+
+struct RelocationTable {
+    unsigned int offset;
+    unsigned int segment;
+};
+
+static unsigned long seed = DEFAULT_SEED;
+static unsigned char *module = NULL; /* load module as linked */
+static unsigned long moduleSize = 0;
+static unsigned long fixups[MAX_FIXUPS]; /* linear offsets, sorted */
+static unsigned int fixupsCount = 0;
+static unsigned int failures = 0;
+static unsigned int checks = 0;
+
+unsigned int getRandom(unsigned int range) {
+    seed = seed * 1103515245UL + 12345UL;
+    return (unsigned int)((seed >> 16) % range);
+}
+
+void check(int isPassed, char *name) {
+    checks++;
+    if(!isPassed) {
+        failures++;
+        printf("FAIL: %s\n", name);
+    }
+}
+
+unsigned int readWord(unsigned char *address) {
+    return address[0] | ((unsigned int)address[1] << 8);
+}
+
+void writeWord(unsigned char *address, unsigned int value) {
+    address[0] = (unsigned char)value;
+    address[1] = (unsigned char)(value >> 8);
+}
+
+void buildModule(void) {
+    /* repeated runs of random bytes, like code, then the fixups: gaps of
+       one byte, escaped gaps, fixups across the sectors of the MZ file and
+       a gap of more than a window. The code words refer to the code */
+    unsigned long codeSize = (unsigned long)CODE_PARAGRAPHS << 4;
+    unsigned long position;
+    unsigned long gap;
+    unsigned int length;
+    unsigned int distance;
+    unsigned int value;
+
+    moduleSize = ((unsigned long)(CODE_PARAGRAPHS + DATA_PARAGRAPHS) << 4) - MODULE_TAIL;
+    module = (unsigned char *)malloc(moduleSize);
+    for(position = 0; position < moduleSize; position += length) {
+        length = 3 + getRandom(40);
+        distance = 1 + getRandom(4000);
+        if(length > moduleSize - position) {
+            length = (unsigned int)(moduleSize - position);
+        }
+        if(position >= distance && getRandom(2)) {
+            for(value = 0; value < length; value++) {
+                module[position + value] = module[position - distance + value];
+            }
+        }
+        else {
+            for(value = 0; value < length; value++) {
+                module[position + value] = (unsigned char)getRandom(256);
+            }
+        }
+    }
+
+    fixupsCount = 0;
+    position = 0;
+    while(fixupsCount < MAX_FIXUPS) {
+        value = getRandom(400);
+        if(value == 0) {
+            gap = NXE_WINDOW_SIZE + getRandom(100); /* next window */
+        }
+        else if(value < 20) {
+            gap = 256 + getRandom(4000); /* escaped */
+        }
+        else if(value < 40) {
+            gap = SECTOR_SIZE - 1 - (position + EXE_HEADER_PARAGRAPHS * 16UL) % SECTOR_SIZE; /* across */
+        }
+        else {
+            gap = 2 + getRandom(60);
+        }
+        if(gap < 2) {
+            gap += SECTOR_SIZE;
+        }
+        position += gap;
+        if(position < codeSize && position + 2 > codeSize) {
+            position = codeSize;
+        }
+        if(position + 2 > moduleSize) {
+            break;
+        }
+        value = position < codeSize ? getRandom(CODE_PARAGRAPHS) : getRandom(CODE_PARAGRAPHS + DATA_PARAGRAPHS);
+        writeWord(module + position, value);
+        fixups[fixupsCount++] = position;
+    }
+}
+
+int writeExecutable(void) {
+    /* MZ file with the relocations in random order and segment:offset forms */
+    static struct RelocationTable relocations[MAX_FIXUPS];
+    struct ExecutableFile header;
+    unsigned long fileSize = ((unsigned long)EXE_HEADER_PARAGRAPHS << 4) + moduleSize;
+    unsigned long headerBytes = sizeof(struct ExecutableFile);
+    unsigned int index;
+    unsigned int other;
+    unsigned int segment;
+    struct RelocationTable relocation;
+    FILE *exeFile;
+
+    for(index = 0; index < fixupsCount; index++) {
+        segment = (unsigned int)(fixups[index] >> 4);
+        segment -= getRandom(segment < 0xfff ? segment + 1 : 0xfff);
+        relocations[index].segment = segment;
+        relocations[index].offset = (unsigned int)(fixups[index] - ((unsigned long)segment << 4));
+    }
+    for(index = fixupsCount; index > 1; index--) {
+        other = getRandom(index);
+        relocation = relocations[index - 1];
+        relocations[index - 1] = relocations[other];
+        relocations[other] = relocation;
+    }
+
+    header.signature = 0x5a4d;
+    header.imageLength = (unsigned int)(fileSize % SECTOR_SIZE);
+    header.fileSize = (unsigned int)((fileSize + SECTOR_SIZE - 1) / SECTOR_SIZE);
+    header.relocationItems = fixupsCount;
+    header.headerSize = EXE_HEADER_PARAGRAPHS;
+    header.minParagraphs = MIN_PARAGRAPHS;
+    header.maxParagraphs = 0xffff;
+    header.stackSegment = CODE_PARAGRAPHS; /* start of DGROUP */
+    header.stackPointer = 0x400;
+    header.checksum = 0;
+    header.instructionPointer = 0x10;
+    header.codeSegment = 1;
+    header.relocationItemOffset = (unsigned int)headerBytes;
+    header.overlayNumber = 0;
+
+    exeFile = fopen(EXE_NAME, "wb");
+    if(exeFile == NULL) {
+        return 0;
+    }
+    fwrite(&header, sizeof(struct ExecutableFile), 1, exeFile);
+    fwrite(relocations, sizeof(struct RelocationTable), fixupsCount, exeFile);
+    for(headerBytes += (unsigned long)fixupsCount * sizeof(struct RelocationTable);
+        headerBytes < ((unsigned long)EXE_HEADER_PARAGRAPHS << 4); headerBytes++) {
+        fputc(0, exeFile);
+    }
+    fwrite(module, 1, moduleSize, exeFile);
+    fclose(exeFile);
+    return 1;
+}
+
+int convert(char *arguments) {
+    static char command[256];
+    sprintf(command, "./nosexe -exe %s %s >/dev/null", EXE_NAME, arguments);
+    return system(command) == 0;
+}
+
+int pack(char *inName, char *outName) {
+    static char command[256];
+    sprintf(command, "./nospack -in %s -out %s >/dev/null", inName, outName);
+    return system(command) == 0;
+}
+
+int isSameFile(char *name, char *otherName) {
+    FILE *file = fopen(name, "rb");
+    FILE *otherFile = fopen(otherName, "rb");
+    int character = 0;
+    int isEqual = file != NULL && otherFile != NULL;
+
+    while(isEqual && character != EOF) {
+        character = fgetc(file);
+        isEqual = character == fgetc(otherFile);
+    }
+    if(file != NULL) {
+        fclose(file);
+    }
+    if(otherFile != NULL) {
+        fclose(otherFile);
+    }
+    return isEqual;
+}
+
+int openImage(char *name, struct File *file, struct NativeExecutableFile *nativeHeader) {
+    file->stream = fopen(name, "rb");
+    if(file->stream == NULL) {
+        return 0;
+    }
+    fseek(file->stream, 0, SEEK_END);
+    file->size = (unsigned long)ftell(file->stream);
+    return readFile(file, 0, nativeHeader, sizeof(struct NativeExecutableFile)) ==
+           sizeof(struct NativeExecutableFile) && nativeHeader->signature == NXE_SIGNATURE &&
+           nativeHeader->version == NXE_VERSION;
+}
+
+int loadModule(struct File *file, struct NativeExecutableFile *nativeHeader, unsigned long offset,
+               unsigned int segment, unsigned long size) {
+    /* @see loadNativeImage, offset is in the load module */
+    unsigned long moduleOffset = (unsigned long)nativeHeader->headerSectors * SECTOR_SIZE;
+    return readFile(file, moduleOffset + offset, MK_FP(segment, 0), size) == size;
+}
+
+int isRelocated(unsigned int segment, unsigned long first, unsigned long size,
+                unsigned int codeDelta, unsigned int dataDelta) {
+    /* the words below CODE_PARAGRAPHS refer to the code, every delta is
+       added to the linked module, which has no base */
+    unsigned char *image = (unsigned char *)MK_FP(segment, 0);
+    unsigned char *expected = (unsigned char *)malloc(size);
+    unsigned int index;
+    unsigned int value;
+    int isEqual;
+
+    memcpy(expected, module + first, size);
+    for(index = 0; index < fixupsCount; index++) {
+        if(fixups[index] < first || fixups[index] >= first + size) {
+            continue;
+        }
+        value = readWord(module + fixups[index]);
+        writeWord(expected + (fixups[index] - first), value + (value < CODE_PARAGRAPHS ? codeDelta : dataDelta));
+    }
+    isEqual = memcmp(image, expected, size) == 0;
+    free(expected);
+    return isEqual;
+}
+
+void testConvert(void) {
+    struct NativeExecutableFile nativeHeader;
+    struct File file;
+
+    check(convert("-out " NXE_NAME), "nosexe");
+    check(openImage(NXE_NAME, &file, &nativeHeader), "nxe header");
+    check(nativeHeader.flags == 0 && nativeHeader.linkedBase == 0 && nativeHeader.codeParagraphs == 0,
+          "nxe flags");
+    check(nativeHeader.loadModuleSize == moduleSize && nativeHeader.minParagraphs == MIN_PARAGRAPHS,
+          "nxe sizes");
+    check(nativeHeader.fixupsCount == fixupsCount && nativeHeader.fixupWindows > 1, "nxe fixups");
+    check(file.size == (unsigned long)nativeHeader.headerSectors * SECTOR_SIZE + moduleSize, "nxe file size");
+
+    check(loadModule(&file, &nativeHeader, 0, LOAD_BASE, moduleSize) &&
+          relocateNativeImage(&file, &nativeHeader, LOAD_BASE, LOAD_BASE, 1) &&
+          isRelocated(LOAD_BASE, 0, moduleSize, LOAD_BASE, LOAD_BASE), "relocate");
+    fclose(file.stream);
+}
+
+void testLinkedBase(void) {
+    /* no fixups at the linked base, the difference anywhere else */
+    struct NativeExecutableFile nativeHeader;
+    struct File file;
+
+    check(convert("-out " BASE_NAME " -base 2345"), "nosexe -base");
+    check(openImage(BASE_NAME, &file, &nativeHeader) && nativeHeader.linkedBase == LINKED_BASE,
+          "nxe -base header");
+    check(loadModule(&file, &nativeHeader, 0, LINKED_BASE, moduleSize) &&
+          relocateNativeImage(&file, &nativeHeader, LINKED_BASE, LINKED_BASE, 1) &&
+          isRelocated(LINKED_BASE, 0, moduleSize, LINKED_BASE, LINKED_BASE), "load at the linked base");
+    check(loadModule(&file, &nativeHeader, 0, OTHER_BASE, moduleSize) &&
+          relocateNativeImage(&file, &nativeHeader, OTHER_BASE, OTHER_BASE, 1) &&
+          isRelocated(OTHER_BASE, 0, moduleSize, OTHER_BASE, OTHER_BASE), "load away from the linked base");
+    fclose(file.stream);
+
+    check(convert("-out " STRIP_NAME " -base 2345 -strip"), "nosexe -strip");
+    check(openImage(STRIP_NAME, &file, &nativeHeader) && (nativeHeader.flags & NXE_FIXED_BASE) &&
+          nativeHeader.fixupsCount == 0 && nativeHeader.headerSectors == 1, "nxe -strip header");
+    check(loadModule(&file, &nativeHeader, 0, LINKED_BASE, moduleSize) &&
+          relocateNativeImage(&file, &nativeHeader, LINKED_BASE, LINKED_BASE, 1) &&
+          isRelocated(LINKED_BASE, 0, moduleSize, LINKED_BASE, LINKED_BASE), "stripped at the linked base");
+    check(!relocateNativeImage(&file, &nativeHeader, OTHER_BASE, OTHER_BASE, 1), "stripped elsewhere");
+    fclose(file.stream);
+}
+
+void testSharedCode(void) {
+    /* two instances: the first one loads and relocates the code, the second
+       one relocates its data only. The data refers to the code of both */
+    struct NativeExecutableFile nativeHeader;
+    struct File file;
+    unsigned long codeSize = (unsigned long)CODE_PARAGRAPHS << 4;
+    unsigned int dataDelta = DATA_BASE - CODE_PARAGRAPHS;
+    unsigned int secondDataDelta = SECOND_DATA_BASE - CODE_PARAGRAPHS;
+
+    check(convert("-out " SHARE_NAME " -share"), "nosexe -share");
+    check(openImage(SHARE_NAME, &file, &nativeHeader) && (nativeHeader.flags & NXE_SHARED_CODE) &&
+          nativeHeader.codeParagraphs == CODE_PARAGRAPHS, "nxe -share header");
+
+    check(loadModule(&file, &nativeHeader, 0, CODE_BASE, codeSize) &&
+          loadModule(&file, &nativeHeader, codeSize, DATA_BASE, moduleSize - codeSize) &&
+          relocateNativeImage(&file, &nativeHeader, CODE_BASE, DATA_BASE, 1), "first instance");
+    check(isRelocated(CODE_BASE, 0, codeSize, CODE_BASE, CODE_BASE), "first instance code");
+    check(isRelocated(DATA_BASE, codeSize, moduleSize - codeSize, CODE_BASE, dataDelta), "first instance data");
+
+    check(loadModule(&file, &nativeHeader, codeSize, SECOND_DATA_BASE, moduleSize - codeSize) &&
+          relocateNativeImage(&file, &nativeHeader, CODE_BASE, SECOND_DATA_BASE, 0), "second instance");
+    check(isRelocated(CODE_BASE, 0, codeSize, CODE_BASE, CODE_BASE), "code relocated once");
+    check(isRelocated(SECOND_DATA_BASE, codeSize, moduleSize - codeSize, CODE_BASE, secondDataDelta),
+          "second instance data");
+    check(isRelocated(DATA_BASE, codeSize, moduleSize - codeSize, CODE_BASE, dataDelta), "first data kept");
+    fclose(file.stream);
+}
+
+void testPack(void) {
+    /* the packed module is expanded across the 64KB offsets of its segment,
+       to the same bytes as the plain one, then it relocates the same way */
+    struct NativeExecutableFile nativeHeader;
+    struct File file;
+    unsigned long moduleOffset;
+
+    check(pack(NXE_NAME, PACK_NAME), "nospack");
+    check(openImage(PACK_NAME, &file, &nativeHeader) && (nativeHeader.flags & NXE_COMPRESSED) &&
+          nativeHeader.loadModuleSize == moduleSize && nativeHeader.packedSize < moduleSize &&
+          nativeHeader.fixupsCount == fixupsCount, "packed header");
+    moduleOffset = (unsigned long)nativeHeader.headerSectors * SECTOR_SIZE;
+    check(file.size == moduleOffset + nativeHeader.packedSize, "packed file size");
+
+    check(unpackImage(&file, moduleOffset, nativeHeader.packedSize, MK_FP(PACK_BASE, 0), moduleSize) &&
+          memcmp(MK_FP(PACK_BASE, 0), module, moduleSize) == 0, "unpack");
+    check(relocateNativeImage(&file, &nativeHeader, PACK_BASE, PACK_BASE, 1) &&
+          isRelocated(PACK_BASE, 0, moduleSize, PACK_BASE, PACK_BASE), "relocate unpacked");
+    check(!unpackImage(&file, moduleOffset, nativeHeader.packedSize - 1, MK_FP(PACK_BASE, 0), moduleSize),
+          "truncated stream");
+    fclose(file.stream);
+
+    /* shared code is read apart from the data, it is stored as is */
+    check(pack(SHARE_NAME, SHARE_PACK_NAME) && isSameFile(SHARE_NAME, SHARE_PACK_NAME), "shared code stored");
+}
+
+int main(int argc, char *argv[]) {
+    if(argc > 1) {
+        seed = strtoul(argv[1], NULL, 10);
+    }
+    printf("nxetest: seed %lu, ", seed);
+    initializeHost();
+    buildModule();
+    if(!writeExecutable()) {
+        printf("FAIL: can't write %s\n", EXE_NAME);
+        return EXIT_FAILURE;
+    }
+    printf("%lu bytes load module, %u fixups\n", moduleSize, fixupsCount);
+
+    testConvert();
+    testLinkedBase();
+    testSharedCode();
+    testPack();
+
+    remove(EXE_NAME);
+    remove(NXE_NAME);
+    remove(BASE_NAME);
+    remove(STRIP_NAME);
+    remove(SHARE_NAME);
+    remove(PACK_NAME);
+    remove(SHARE_PACK_NAME);
+    free(module);
+    printf("%u of %u checks failed\n", failures, checks);
+    return failures ? EXIT_FAILURE : EXIT_SUCCESS;
+}
\ No newline at end of file